@@ -30,6 +30,11 @@ class logger : public ebus::ILogger
 {
 
 public:
+	ebus::LogLevel level() const
+	{
+		return (ebus::LogLevel::info);
+	}
+
 	void error(const std::string &message)
 	{
 		std::cout << "ERROR:   " << message << std::endl;
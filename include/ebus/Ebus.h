@@ -20,6 +20,7 @@
 #ifndef EBUS_EBUS_H
 #define EBUS_EBUS_H
 
+#include <chrono>
 #include <cstddef>
 #include <experimental/propagate_const>
 #include <functional>
@@ -30,6 +31,19 @@
 namespace ebus
 {
 
+/**
+ * log levels: a logger receives the messages up to its level
+ */
+enum class LogLevel
+{
+	off,	// no messages
+	error,	// errors
+	warn,	// warnings
+	info,	// telegrams and device state
+	debug,	// state machine details
+	trace	// every byte
+};
+
 /**
  * logger interface
  */
@@ -39,12 +53,45 @@ class ILogger
 public:
 	virtual ~ILogger() = default;
 
+	// messages above this level are neither formatted nor passed on [default: trace]
+	virtual LogLevel level() const
+	{
+		return (LogLevel::trace);
+	}
+
 	virtual void error(const std::string &message) = 0;
 	virtual void warn(const std::string &message) = 0;
 	virtual void info(const std::string &message) = 0;
 	virtual void debug(const std::string &message) = 0;
 	virtual void trace(const std::string &message) = 0;
 
+	// entry of all messages, time is the point of logging (earlier than the call with asynchronous logging)
+	virtual void log(const LogLevel level, const std::chrono::steady_clock::time_point &time, const std::string &message)
+	{
+		(void) time;
+
+		switch (level)
+		{
+		case LogLevel::error:
+			error(message);
+			break;
+		case LogLevel::warn:
+			warn(message);
+			break;
+		case LogLevel::info:
+			info(message);
+			break;
+		case LogLevel::debug:
+			debug(message);
+			break;
+		case LogLevel::trace:
+			trace(message);
+			break;
+		default:
+			break;
+		}
+	}
+
 };
 
 /**
@@ -58,6 +105,125 @@ enum class Reaction
 	response	// send response
 };
 
+/**
+ * device health and uart error counters
+ */
+struct DeviceCounters
+{
+	bool online = false;	// device is open and the line is alive
+	long disconnects = 0;	// number of detected device disconnects
+
+	bool supported = false;	// uart counters are provided by the device driver
+	long rx = 0;		// received bytes
+	long tx = 0;		// transmitted bytes
+	long frame = 0;		// framing errors
+	long overrun = 0;	// uart overrun errors
+	long parity = 0;	// parity errors
+	long brk = 0;		// break conditions
+	long buf_overrun = 0;	// tty buffer overrun errors
+};
+
+/**
+ * low latency settings of the serial device
+ */
+struct LowLatency
+{
+	bool enabled = false;		// low latency mode requested
+	bool async_low_latency = false;	// ASYNC_LOW_LATENCY flag of the serial driver is set
+	int latency_timer = -1;		// latency timer of usb serial converters in ms (-1: not available)
+};
+
+/**
+ * arbitration statistics (times in us)
+ */
+struct ArbitrationStats
+{
+	long attempts = 0;		// sent address bytes
+	long won = 0;			// won arbitrations
+	long lost = 0;			// lost arbitrations
+	long missed = 0;		// skipped SYN because the send deadline had already passed
+	long timeouts = 0;		// no echo until the echo deadline
+
+	long send_error_max = 0;	// largest lateness of the address byte against its deadline
+	double send_error_mean = 0;	// mean lateness of the address byte against its deadline
+	long echo_delay_min = 0;	// shortest time between sending and receiving the address byte
+	long echo_delay_max = 0;	// longest time between sending and receiving the address byte
+	double echo_delay_mean = 0;	// mean time between sending and receiving the address byte
+};
+
+/**
+ * real-time profile of the bus thread
+ */
+struct RealTime
+{
+	int priority = 0;		// SCHED_FIFO priority 1..99 (0: default scheduling)
+	int cpu = -1;			// cpu the bus thread is bound to (-1: all cpus)
+	bool lock_memory = false;	// lock all process pages in memory (mlockall) and pre-fault the thread stack
+};
+
+/**
+ * reply timing: acknowledge and response bytes have to be written within one
+ * byte time (4167 us) after the byte they answer has been received
+ */
+struct TimingStats
+{
+	long replies = 0;	// written acknowledge and response bytes
+	long missed = 0;	// replies written after their window
+	long delay_max = 0;	// longest reply delay in us
+};
+
+/**
+ * non-owning view of the bytes of an ebus sequence, only valid while the callback it is passed to runs
+ */
+class SequenceView
+{
+
+public:
+	SequenceView() = default;
+	SequenceView(const std::byte *data, const size_t size) : m_data(data), m_size(size)
+	{
+	}
+
+	const std::byte* data() const
+	{
+		return (m_data);
+	}
+
+	size_t size() const
+	{
+		return (m_size);
+	}
+
+	bool empty() const
+	{
+		return (m_size == 0);
+	}
+
+	const std::byte& operator[](const size_t index) const
+	{
+		return (m_data[index]);
+	}
+
+	const std::byte* begin() const
+	{
+		return (m_data);
+	}
+
+	const std::byte* end() const
+	{
+		return (m_data + m_size);
+	}
+
+	const std::vector<std::byte> to_vector() const
+	{
+		return (std::vector<std::byte>(begin(), end()));
+	}
+
+private:
+	const std::byte *m_data = nullptr;
+	size_t m_size = 0;
+};
+
 /**
  * ebus communication class
  */
@@ -69,7 +235,10 @@ public:
 	 * create an ebus object
 	 *
 	 * @param address - own address byte
-	 * @param device - serial device string
+	 * @param device - serial device string or network device 'tcp:host:port'
+	 *                 prefix 'enh:' selects the enhanced adapter protocol
+	 *                 raw capture file 'replay:file' (as fast as possible) or 'replay-paced:file' (2400 baud),
+	 *                 a replay starts with open() only
 	 */
 	Ebus(const std::byte address, const std::string &device);
 
@@ -107,6 +276,48 @@ public:
 	 */
 	bool online();
 
+	/**
+	 * ebus device health and uart error counters (sampled once per second)
+	 *
+	 * @return last sampled device counters
+	 */
+	const DeviceCounters device_counters();
+
+	/**
+	 * settings of the low latency mode which took effect on the ebus device
+	 *
+	 * @return low latency settings
+	 */
+	const LowLatency low_latency();
+
+	/**
+	 * arbitration statistics of the own address (timing values of plain devices only)
+	 *
+	 * @return arbitration statistics
+	 */
+	const ArbitrationStats arbitration_stats();
+
+	/**
+	 * reply timing statistics of the bus thread
+	 *
+	 * @return timing statistics
+	 */
+	const TimingStats timing_stats();
+
+	/**
+	 * settings of the real-time profile which took effect on the bus thread
+	 *
+	 * @return real-time settings
+	 */
+	const RealTime realtime();
+
+	/**
+	 * number of log records lost because the asynchronous log sink was full
+	 *
+	 * @return lost log records
+	 */
+	long log_overflows();
+
 	/**
 	 * transmit an ebus message
 	 *
@@ -147,6 +358,32 @@ public:
 	void register_publish(
 		std::function<void(const std::vector<std::byte> &message, const std::vector<std::byte> &response)> publish);
 
+	/**
+	 * register a 'publish' reference with receive time of the first and last telegram byte
+	 *
+	 * @param publish callback function
+	 */
+	void register_publish(
+		std::function<void(const std::vector<std::byte> &message, const std::vector<std::byte> &response,
+			const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)> publish);
+
+	/**
+	 * register a 'publish' reference which receives views of the telegram bytes (no copies)
+	 *
+	 * @param publish callback function
+	 */
+	void register_publish(std::function<void(const SequenceView &message, const SequenceView &response)> publish);
+
+	/**
+	 * register a 'publish' reference which receives views of the telegram bytes with receive time
+	 * of the first and last telegram byte
+	 *
+	 * @param publish callback function
+	 */
+	void register_publish(
+		std::function<void(const SequenceView &message, const SequenceView &response,
+			const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)> publish);
+
 	/**
 	 * register a 'rawdata' reference which is triggered after each received byte
 	 *
@@ -155,12 +392,59 @@ public:
 	void register_rawdata(std::function<void(const std::byte &byte)> rawdata);
 
 	/**
-	 * timeout for bus access
+	 * register a 'rawdata' reference with receive time (monotonic clock) of each received byte
+	 *
+	 * @param rawdata callback function
+	 */
+	void register_rawdata(std::function<void(const std::byte &byte, const std::chrono::steady_clock::time_point &time)> rawdata);
+
+	/**
+	 * timeout for bus access: the echo of the own address byte has to be received
+	 * until send deadline + access timeout (+ 10 ms transfer tolerance)
 	 *
 	 * @param access_timeout [default: 4400 us]
 	 */
 	void set_access_timeout(const long &access_timeout);
 
+	/**
+	 * delay of the own address byte after receiving SYN (send deadline)
+	 *
+	 * @param arbitration_delay [default: 0 us]
+	 */
+	void set_arbitration_delay(const long &arbitration_delay);
+
+	/**
+	 * low latency mode of serial devices: sets ASYNC_LOW_LATENCY and the
+	 * latency timer of usb serial converters to 1 ms (where supported)
+	 *
+	 * @param low_latency [default: false]
+	 */
+	void set_low_latency(const bool &low_latency);
+
+	/**
+	 * pipelined sending: remaining telegram bytes incl. CRC are written at once
+	 * and the echo is verified afterwards (telegram is aborted on mismatch)
+	 *
+	 * @param pipelined_send [default: false]
+	 */
+	void set_pipelined_send(const bool &pipelined_send);
+
+	/**
+	 * real-time profile of the bus thread (applied by the bus thread itself,
+	 * mostly requires CAP_SYS_NICE and CAP_IPC_LOCK)
+	 *
+	 * @param realtime [default: no real-time settings]
+	 */
+	void set_realtime(const RealTime &realtime);
+
+	/**
+	 * logging in a background thread, the bus thread only stores binary records
+	 * in a lock-free ring which is never waited for (overflowing records are counted)
+	 *
+	 * @param async_log [default: false]
+	 */
+	void set_async_log(const bool &async_log);
+
 	/**
 	 * number of skipped characters after a successful ebus access
 	 *
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_HEX_H
+#define EBUS_HEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ebus
+{
+
+// table driven hex codec writing into caller buffers, lower case digits like all string functions of ebus
+namespace hex
+{
+
+// result of decode for odd input or invalid digits
+constexpr size_t invalid = size_t(-1);
+
+constexpr std::array<char, 512> make_encode_table()
+{
+	std::array<char, 512> table{};
+
+	const char digits[] = "0123456789abcdef";
+
+	for (int i = 0; i < 256; i++)
+	{
+		table[2 * i] = digits[i >> 4];
+		table[2 * i + 1] = digits[i & 0x0f];
+	}
+
+	return (table);
+}
+
+// value of a digit or -1
+constexpr std::array<std::int8_t, 256> make_decode_table()
+{
+	std::array<std::int8_t, 256> table{};
+
+	for (int i = 0; i < 256; i++)
+	{
+		if (i >= '0' && i <= '9')
+			table[i] = std::int8_t(i - '0');
+		else if (i >= 'a' && i <= 'f')
+			table[i] = std::int8_t(i - 'a' + 10);
+		else if (i >= 'A' && i <= 'F')
+			table[i] = std::int8_t(i - 'A' + 10);
+		else
+			table[i] = -1;
+	}
+
+	return (table);
+}
+
+constexpr std::array<char, 512> encode_table = make_encode_table();
+constexpr std::array<std::int8_t, 256> decode_table = make_decode_table();
+
+/**
+ * encode bytes as hex digits (no terminating zero)
+ *
+ * @param data bytes to encode
+ * @param size number of bytes
+ * @param out buffer of at least 2 * size chars
+ * @return number of written chars
+ */
+inline size_t encode(const std::byte *data, const size_t size, char *out)
+{
+	for (size_t i = 0; i < size; i++)
+		std::memcpy(out + 2 * i, &encode_table[2 * std::to_integer<size_t>(data[i])], 2);
+
+	return (2 * size);
+}
+
+/**
+ * decode hex digits (upper or lower case) into bytes
+ *
+ * @param in digits to decode
+ * @param size number of digits
+ * @param out buffer of at least size / 2 bytes (undefined content if the input is invalid)
+ * @return number of written bytes or invalid for an odd size or a wrong digit
+ */
+inline size_t decode(const char *in, const size_t size, std::byte *out)
+{
+	if (size % 2 != 0) return (invalid);
+
+	// invalid digits are collected and checked once at the end
+	std::int8_t error = 0;
+
+	for (size_t i = 0; i < size / 2; i++)
+	{
+		const std::int8_t high = decode_table[static_cast<unsigned char>(in[2 * i])];
+		const std::int8_t low = decode_table[static_cast<unsigned char>(in[2 * i + 1])];
+
+		error |= high | low;
+		out[i] = std::byte((std::uint8_t(high) << 4) | (low & 0x0f));
+	}
+
+	return (error < 0 ? invalid : size / 2);
+}
+
+} // namespace hex
+
+} // namespace ebus
+
+#endif // EBUS_HEX_H
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_PROTOCOL_H
+#define EBUS_PROTOCOL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace ebus
+{
+
+// protocol tables and a builder for fixed telegrams, all evaluated at compile time
+namespace protocol
+{
+
+constexpr std::byte sym_exp = std::byte(0xa9);    // expand byte
+constexpr std::byte sym_syn = std::byte(0xaa);    // synchronization byte
+constexpr std::byte sym_synexp = std::byte(0x01); // expanded synchronization byte
+constexpr std::byte sym_expexp = std::byte(0x00); // expanded expand byte
+
+constexpr std::uint8_t addr_master = 0x01;        // master address
+constexpr std::uint8_t addr_slave = 0x02;         // slave address
+constexpr std::uint8_t addr_valid = 0x04;         // usable as target address
+
+constexpr bool master_nibble(const int nibble)
+{
+	return (nibble == 0x0 || nibble == 0x1 || nibble == 0x3 || nibble == 0x7 || nibble == 0xf);
+}
+
+constexpr std::array<std::uint8_t, 256> make_address_table()
+{
+	std::array<std::uint8_t, 256> table{};
+
+	for (int i = 0; i < 256; i++)
+	{
+		const bool valid = std::byte(i) != sym_syn && std::byte(i) != sym_exp;
+		const bool master = master_nibble(i >> 4) && master_nibble(i & 0x0f);
+
+		table[i] = (master ? addr_master : 0) | (valid && !master ? addr_slave : 0) | (valid ? addr_valid : 0);
+	}
+
+	return (table);
+}
+
+constexpr std::array<std::uint8_t, 256> address_table = make_address_table();
+
+// slave address belonging to an address: slaves map to themselves, masters to master + 5
+constexpr std::array<std::byte, 256> make_slave_table()
+{
+	std::array<std::byte, 256> table{};
+
+	for (int i = 0; i < 256; i++)
+		table[i] = (address_table[i] & addr_slave) ? std::byte(i) : std::byte((i + 5) & 0xff);
+
+	return (table);
+}
+
+constexpr std::array<std::byte, 256> slave_table = make_slave_table();
+
+// CRC8 of the polynom 0x9b = x^8 + x^7 + x^4 + x^3 + x^1 + 1
+constexpr std::array<std::byte, 256> make_crc_table()
+{
+	std::array<std::byte, 256> table{};
+
+	for (int i = 0; i < 256; i++)
+	{
+		int crc = i;
+
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc & 0x80) ? ((crc << 1) ^ 0x9b) & 0xff : (crc << 1) & 0xff;
+
+		table[i] = std::byte(crc);
+	}
+
+	return (table);
+}
+
+constexpr std::array<std::byte, 256> crc_table = make_crc_table();
+
+constexpr bool is_master(const std::byte byte)
+{
+	return (address_table[std::to_integer<std::uint8_t>(byte)] & addr_master);
+}
+
+constexpr bool is_slave(const std::byte byte)
+{
+	return (address_table[std::to_integer<std::uint8_t>(byte)] & addr_slave);
+}
+
+constexpr bool is_valid(const std::byte byte)
+{
+	return (address_table[std::to_integer<std::uint8_t>(byte)] & addr_valid);
+}
+
+constexpr std::byte slave_address(const std::byte address)
+{
+	return (slave_table[std::to_integer<std::uint8_t>(address)]);
+}
+
+constexpr std::byte crc_update(const std::byte byte, const std::byte init)
+{
+	return (crc_table[std::to_integer<std::uint8_t>(init)] ^ byte);
+}
+
+// expanded wire bytes of a master telegram (QQ ZZ PB SB NN DBx CRC) and its CRC
+template<size_t N>
+struct Wire
+{
+	std::array<std::byte, N> bytes{};
+	size_t size = 0;
+	std::byte crc{};
+
+	constexpr const std::byte* data() const
+	{
+		return (bytes.data());
+	}
+
+	constexpr std::byte operator[](const size_t index) const
+	{
+		return (bytes[index]);
+	}
+
+	constexpr void push(const std::byte byte)
+	{
+		if (byte == sym_exp || byte == sym_syn)
+		{
+			bytes[size++] = sym_exp;
+			bytes[size++] = byte == sym_exp ? sym_expexp : sym_synexp;
+		}
+		else
+		{
+			bytes[size++] = byte;
+		}
+	}
+};
+
+constexpr int hex_nibble(const char c)
+{
+	if (c >= '0' && c <= '9') return (c - '0');
+	if (c >= 'a' && c <= 'f') return (c - 'a' + 10);
+	if (c >= 'A' && c <= 'F') return (c - 'A' + 10);
+
+	throw std::invalid_argument("invalid hex digit");
+}
+
+/**
+ * build a master telegram at compile time
+ *
+ *   constexpr auto poll = ebus::protocol::telegram(std::byte(0xff), "52b509030d0600");
+ *
+ * @param source address (QQ)
+ * @param message in hex without source and CRC (ZZ PB SB NN DBx)
+ * @return expanded wire bytes incl. CRC
+ */
+template<size_t N>
+constexpr Wire<2 * ((N - 1) / 2 + 2)> telegram(const std::byte source, const char (&message)[N])
+{
+	static_assert((N - 1) % 2 == 0, "message must consist of complete hex bytes");
+	static_assert((N - 1) / 2 >= 4, "message is too short");
+
+	const size_t count = (N - 1) / 2;
+
+	if (!is_master(source)) throw std::invalid_argument("source address is invalid");
+
+	std::array<std::byte, count> reduced{};
+
+	for (size_t i = 0; i < count; i++)
+		reduced[i] = std::byte(hex_nibble(message[2 * i]) << 4 | hex_nibble(message[2 * i + 1]));
+
+	if (!is_valid(reduced[0])) throw std::invalid_argument("target address is invalid");
+
+	if (count - 4 > 16) throw std::invalid_argument("number of data bytes is invalid");
+
+	if (std::to_integer<size_t>(reduced[3]) != count - 4) throw std::invalid_argument("number of data bytes does not fit");
+
+	Wire<2 * ((N - 1) / 2 + 2)> wire{};
+
+	wire.push(source);
+
+	for (size_t i = 0; i < count; i++)
+		wire.push(reduced[i]);
+
+	// CRC is calculated over the expanded bytes
+	for (size_t i = 0; i < wire.size; i++)
+		wire.crc = crc_update(wire.bytes[i], wire.crc);
+
+	wire.push(wire.crc);
+
+	return (wire);
+}
+
+} // namespace protocol
+
+} // namespace ebus
+
+#endif // EBUS_PROTOCOL_H
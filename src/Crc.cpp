@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "Crc.h"
+
+#include <algorithm>
+
+// independent CRC chains calculated side by side
+static const size_t streams = 4;
+
+std::byte ebus::Crc::calc(const std::byte *data, const size_t size)
+{
+	std::byte crc = std::byte(0x00);
+
+	for (size_t i = 0; i < size; i++)
+		crc = protocol::crc_update(data[i], crc);
+
+	return (crc);
+}
+
+void ebus::Crc::verify(const std::byte *data, const size_t *offsets, const size_t *sizes, const std::byte *crcs,
+	const size_t count, std::uint64_t *bitmap)
+{
+	std::fill(bitmap, bitmap + (count + 63) / 64, 0);
+
+	size_t i = 0;
+
+	// several parts side by side: independent chains hide the latency of the table lookups
+	for (; i + streams <= count; i += streams)
+	{
+		const std::byte *d0 = data + offsets[i];
+		const std::byte *d1 = data + offsets[i + 1];
+		const std::byte *d2 = data + offsets[i + 2];
+		const std::byte *d3 = data + offsets[i + 3];
+
+		std::byte c0 = std::byte(0x00), c1 = std::byte(0x00), c2 = std::byte(0x00), c3 = std::byte(0x00);
+
+		const size_t common = std::min(std::min(sizes[i], sizes[i + 1]), std::min(sizes[i + 2], sizes[i + 3]));
+
+		for (size_t j = 0; j < common; j++)
+		{
+			c0 = protocol::crc_update(d0[j], c0);
+			c1 = protocol::crc_update(d1[j], c1);
+			c2 = protocol::crc_update(d2[j], c2);
+			c3 = protocol::crc_update(d3[j], c3);
+		}
+
+		for (size_t j = common; j < sizes[i]; j++)
+			c0 = protocol::crc_update(d0[j], c0);
+
+		for (size_t j = common; j < sizes[i + 1]; j++)
+			c1 = protocol::crc_update(d1[j], c1);
+
+		for (size_t j = common; j < sizes[i + 2]; j++)
+			c2 = protocol::crc_update(d2[j], c2);
+
+		for (size_t j = common; j < sizes[i + 3]; j++)
+			c3 = protocol::crc_update(d3[j], c3);
+
+		const std::uint64_t valid = (c0 == crcs[i] ? 1 : 0) | (c1 == crcs[i + 1] ? 2 : 0) | (c2 == crcs[i + 2] ? 4 : 0)
+			| (c3 == crcs[i + 3] ? 8 : 0);
+
+		// groups of 4 never cross a word boundary
+		bitmap[i / 64] |= valid << (i % 64);
+	}
+
+	for (; i < count; i++)
+		if (calc(data + offsets[i], sizes[i]) == crcs[i]) bitmap[i / 64] |= std::uint64_t(1) << (i % 64);
+}
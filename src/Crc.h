@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_CRC_H
+#define EBUS_CRC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../include/ebus/Protocol.h"
+
+namespace ebus
+{
+
+// CRC8 of the polynom 0x9b as used by ebus (calculated over the extended bytes)
+class Crc
+{
+
+public:
+	static std::byte update(const std::byte byte, const std::byte init)
+	{
+		return (protocol::crc_update(byte, init));
+	}
+
+	static std::byte calc(const std::byte *data, const size_t size);
+
+	// checks count telegram parts at once: part i consists of sizes[i] extended bytes at
+	// data + offsets[i] and its received CRC crcs[i]; bit i of bitmap is set when the CRC
+	// fits (bitmap has to provide (count + 63) / 64 words)
+	static void verify(const std::byte *data, const size_t *offsets, const size_t *sizes, const std::byte *crcs,
+		const size_t count, std::uint64_t *bitmap);
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_CRC_H
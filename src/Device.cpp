@@ -19,15 +19,32 @@
 
 #include "Device.h"
 
-#include <fcntl.h>
 #include <poll.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 
 #include "runtime_warning.h"
 
-ebus::Device::Device(const std::string &device) : m_device(device)
+static const long long nanoseconds_per_second = 1000000000LL;
+
+// time left until a CLOCK_MONOTONIC deadline, false when the deadline has passed
+static bool remaining(const struct timespec &deadline, struct timespec &rest)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	long long left = (deadline.tv_sec - now.tv_sec) * nanoseconds_per_second + (deadline.tv_nsec - now.tv_nsec);
+	if (left <= 0) return (false);
+
+	rest.tv_sec = static_cast<time_t>(left / nanoseconds_per_second);
+	rest.tv_nsec = static_cast<long>(left % nanoseconds_per_second);
+
+	return (true);
+}
+
+ebus::Device::Device(const std::string &device) : m_transport(Transport::create(device))
 {
 }
 
@@ -40,38 +57,20 @@ void ebus::Device::open()
 {
 	if (!m_open)
 	{
-		struct termios newSettings;
-		m_open = false;
-
-		// open file descriptor
-		m_fd = ::open(m_device.c_str(), O_RDWR | O_NOCTTY);
-		if (m_fd < 0 || isatty(m_fd) == 0) throw std::runtime_error("An error occurred while opening the ebus device");
-
-		// save current settings
-		tcgetattr(m_fd, &m_oldSettings);
-
-		// create new settings
-		std::memset(&newSettings, '\0', sizeof(newSettings));
-
-		newSettings.c_cflag |= (B2400 | CS8 | CLOCAL | CREAD);
-		newSettings.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG); // non-canonical mode
-		newSettings.c_iflag |= IGNPAR; // ignore parity errors
-		newSettings.c_oflag &= ~OPOST;
+		m_transport->open();
 
-		// non-canonical mode: read() blocks until at least one byte is available
-		newSettings.c_cc[VMIN] = 1;
-		newSettings.c_cc[VTIME] = 0;
+		m_begin = 0;
+		m_end = 0;
+		m_arbitration = Arbitration::pending;
 
-		// empty device buffer
-		tcflush(m_fd, TCIFLUSH);
-
-		// activate new settings of serial device
-		tcsetattr(m_fd, TCSAFLUSH, &newSettings);
+		m_open = true;
 
-		// set serial device into blocking mode
-		fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_NONBLOCK);
+		if (m_lowLatency) m_lowLatencyChanged = true;
+		applyLowLatency();
 
-		m_open = true;
+		// sample line state and uart counters immediately
+		m_lastCheck = {};
+		check();
 	}
 }
 
@@ -79,17 +78,16 @@ void ebus::Device::close()
 {
 	if (m_open)
 	{
-		// empty device buffer
-		tcflush(m_fd, TCIOFLUSH);
+		m_transport->close();
 
-		// activate old settings of serial device
-		tcsetattr(m_fd, TCSANOW, &m_oldSettings);
+		m_open = false;
 
-		// close file descriptor from serial device
-		::close(m_fd);
+		m_begin = 0;
+		m_end = 0;
 
-		m_fd = -1;
-		m_open = false;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_counters.online = false;
+		m_lowLatencyState = LowLatency();
 	}
 }
 
@@ -100,52 +98,236 @@ bool ebus::Device::isOpen()
 
 void ebus::Device::send(const std::byte byte)
 {
-	isValid();
+	send(&byte, 1);
+}
 
-	// write byte to device
-	int ret = write(m_fd, &byte, 1);
-	if (ret == -1) throw std::runtime_error("An device error occurred while sending data");
+void ebus::Device::send(const std::byte *data, const size_t size)
+{
+	size_t written = 0;
+
+	// write bytes to device
+	while (written < size)
+	{
+		ssize_t ret = m_transport->write(data + written, size - written);
+
+		if (ret > 0)
+		{
+			written += ret;
+		}
+		else if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+		{
+			// non-blocking transports: wait until the bytes can be written
+			wait(POLLOUT, nullptr);
+		}
+		else
+		{
+			disconnect("An device error occurred while sending data");
+		}
+	}
 }
 
 void ebus::Device::recv(std::byte &byte, const long sec, const long nsec)
 {
-	isValid();
+	// poll and read only when all buffered bytes are consumed
+	if (m_begin == m_end) fill(sec, nsec);
+
+	byte = m_buffer[m_begin++];
+}
+
+void ebus::Device::recv(std::byte *data, const size_t size, const long sec, const long nsec)
+{
+	size_t count = 0;
 
-	if (sec > 0 || nsec > 0)
+	while (count < size)
 	{
-		int ret;
-		struct timespec tdiff =
-		{ sec, nsec * 1000L };
+		if (m_begin == m_end) fill(sec, nsec);
 
-		const nfds_t nfds = 1;
-		struct pollfd fds[nfds];
+		size_t len = std::min(size - count, m_end - m_begin);
+		std::memcpy(data + count, m_buffer.data() + m_begin, len);
 
-		std::memset(fds, 0, sizeof(struct pollfd) * nfds);
+		m_begin += len;
+		count += len;
+	}
+}
 
-		fds[0].fd = m_fd;
-		fds[0].events = POLLIN;
+bool ebus::Device::recv(std::byte &byte, Arbitration &result, std::byte &address, const long sec, const long nsec)
+{
+	if (m_begin == m_end && m_arbitration == Arbitration::pending) fill(sec, nsec, true);
 
-		ret = ppoll(fds, nfds, &tdiff, nullptr);
+	if (m_begin == m_end)
+	{
+		result = m_arbitration;
+		address = m_arbitrationAddress;
+		m_arbitration = Arbitration::pending;
 
-		if (ret == -1) throw std::runtime_error("An device error occurred while waiting on ppoll");
-		if (ret == 0) throw ebus::runtime_warning("A timeout occurred while waiting for incoming data");
+		return (false);
 	}
 
-	// read byte from device
-	ssize_t nbytes = read(m_fd, &byte, 1);
-	if (nbytes < 0) throw std::runtime_error("An error occurred while reading file descriptor");
-	if (nbytes == 0) throw ebus::runtime_warning("An EOF occurred while data was being received");
+	byte = m_buffer[m_begin++];
+
+	return (true);
+}
+
+const std::chrono::steady_clock::time_point& ebus::Device::timestamp() const
+{
+	return (m_time);
+}
+
+bool ebus::Device::available() const
+{
+	return (m_begin < m_end);
 }
 
-bool ebus::Device::isValid()
+bool ebus::Device::explicitOpen() const
 {
-	int port;
+	return (m_transport->explicitOpen());
+}
+
+bool ebus::Device::hasArbitration() const
+{
+	return (m_transport->arbitration());
+}
+
+void ebus::Device::arbitrate(const std::byte address)
+{
+	m_arbitration = Arbitration::pending;
+	m_transport->arbitrate(address);
+}
+
+const ebus::DeviceCounters ebus::Device::counters()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return (m_counters);
+}
+
+void ebus::Device::setLowLatency(const bool enable)
+{
+	m_lowLatency = enable;
+	m_lowLatencyChanged = true;
+}
+
+const ebus::LowLatency ebus::Device::lowLatency()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return (m_lowLatencyState);
+}
+
+void ebus::Device::applyLowLatency()
+{
+	if (!m_lowLatencyChanged.exchange(false)) return;
+
+	LowLatency state;
+	m_transport->lowLatency(m_lowLatency, state);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_lowLatencyState = state;
+}
+
+void ebus::Device::disconnect(const std::string &message)
+{
+	close();
 
-	if (ioctl(m_fd, TIOCMGET, &port) == -1)
 	{
-		close();
-		throw std::runtime_error("The file descriptor of the ebus device is invalid");
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_counters.disconnects++;
 	}
 
+	throw std::runtime_error(message);
+}
+
+void ebus::Device::check()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// line state and uart counters are sampled once per second only
+	if (now.tv_sec - m_lastCheck.tv_sec < 1) return;
+
+	m_lastCheck = now;
+
+	DeviceCounters counters = this->counters();
+
+	if (!m_transport->check(counters)) disconnect("The file descriptor of the ebus device is invalid");
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_counters = counters;
+	m_counters.online = true;
+}
+
+bool ebus::Device::wait(const short events, const struct timespec *timeout)
+{
+	short revents = 0;
+
+	int ret = m_transport->poll(events, timeout, revents);
+
+	if (ret == -1 && errno != EINTR) throw std::runtime_error("An device error occurred while waiting on ppoll");
+	if (ret == 0) return (false);
+
+	if ((revents & (POLLHUP | POLLERR | POLLNVAL)) != 0) disconnect("The ebus device has been disconnected");
+
 	return (true);
 }
+
+void ebus::Device::fill(const long sec, const long nsec, const bool result)
+{
+	applyLowLatency();
+	check();
+
+	const bool timed = (sec > 0 || nsec > 0);
+	struct timespec tdiff =
+	{ sec, nsec * 1000L };
+
+	// the timeout covers all waits of this call, also when the transport keeps returning EAGAIN
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	long long end = deadline.tv_nsec + tdiff.tv_nsec;
+	deadline.tv_sec += tdiff.tv_sec + static_cast<time_t>(end / nanoseconds_per_second);
+	deadline.tv_nsec = static_cast<long>(end % nanoseconds_per_second);
+
+	if (timed && !wait(POLLIN, &tdiff))
+		throw ebus::runtime_warning("A timeout occurred while waiting for incoming data");
+
+	// read all available bytes from device (VMIN=1: blocks until at least one byte is available)
+	ssize_t nbytes = m_transport->read(m_buffer.data(), m_buffer.size());
+
+	// non-blocking transports: wait for data and read again
+	while (nbytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+	{
+		// the adapter reported its arbitration result without further data
+		if (collect() && result)
+		{
+			if (!m_transport->timestamp(m_time)) m_time = std::chrono::steady_clock::now();
+
+			m_begin = 0;
+			m_end = 0;
+			return;
+		}
+
+		if (timed && !remaining(deadline, tdiff))
+			throw ebus::runtime_warning("A timeout occurred while waiting for incoming data");
+
+		if (!wait(POLLIN, timed ? &tdiff : nullptr))
+			throw ebus::runtime_warning("A timeout occurred while waiting for incoming data");
+
+		nbytes = m_transport->read(m_buffer.data(), m_buffer.size());
+	}
+
+	if (nbytes < 0) disconnect("An error occurred while reading file descriptor");
+	if (nbytes == 0) throw ebus::runtime_warning("An EOF occurred while data was being received");
+
+	collect();
+
+	// one time stamp per read batch, preferably taken by the kernel
+	if (!m_transport->timestamp(m_time)) m_time = std::chrono::steady_clock::now();
+
+	m_begin = 0;
+	m_end = static_cast<size_t>(nbytes);
+}
+
+bool ebus::Device::collect()
+{
+	if (m_arbitration == Arbitration::pending) m_arbitration = m_transport->arbitrationResult(m_arbitrationAddress);
+
+	return (m_arbitration != Arbitration::pending);
+}
@@ -20,9 +20,18 @@
 #ifndef EBUS_DEVICE_H
 #define EBUS_DEVICE_H
 
-#include <termios.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <mutex>
 #include <string>
 
+#include "../include/ebus/Ebus.h"
+#include "Transport.h"
+
 namespace ebus
 {
 
@@ -38,19 +47,68 @@ public:
 
 	bool isOpen();
 
+	bool explicitOpen() const;
+
 	void send(const std::byte byte);
+	void send(const std::byte *data, const size_t size);
+
 	void recv(std::byte &byte, const long sec, const long nsec);
+	void recv(std::byte *data, const size_t size, const long sec, const long nsec);
 
-private:
-	const std::string m_device;
+	// next byte or, when all bytes received before it are handed out, the result of the adapter
+	// arbitration (returns false) with the address seen on the bus
+	bool recv(std::byte &byte, Arbitration &result, std::byte &address, const long sec, const long nsec);
+
+	const std::chrono::steady_clock::time_point& timestamp() const;
 
-	termios m_oldSettings = {};
+	bool available() const;
 
-	int m_fd = -1;
+	bool hasArbitration() const;
+	void arbitrate(const std::byte address);
+
+	const DeviceCounters counters();
+
+	void setLowLatency(const bool enable);
+	const LowLatency lowLatency();
+
+private:
+	std::unique_ptr<Transport> m_transport;
 
 	bool m_open = false;
 
-	bool isValid();
+	// received bytes not yet handed out by recv()
+	std::array<std::byte, 256> m_buffer = {};
+	size_t m_begin = 0;
+	size_t m_end = 0;
+
+	// receive time of the buffered bytes
+	std::chrono::steady_clock::time_point m_time;
+
+	// arbitration result of the adapter, handed out after the buffered bytes
+	Arbitration m_arbitration = Arbitration::pending;
+	std::byte m_arbitrationAddress = std::byte(0x00);
+
+	// health monitor
+	struct timespec m_lastCheck = {};
+	DeviceCounters m_counters;
+	std::mutex m_mutex;
+
+	// low latency mode (applied by the reading thread)
+	std::atomic<bool> m_lowLatency = false;
+	std::atomic<bool> m_lowLatencyChanged = false;
+	LowLatency m_lowLatencyState;
+
+	void applyLowLatency();
+
+	void disconnect(const std::string &message);
+
+	void check();
+
+	bool wait(const short events, const struct timespec *timeout);
+
+	void fill(const long sec, const long nsec, const bool result = false);
+
+	bool collect();
 
 };
 
@@ -17,23 +17,39 @@
  * along with ebus. If not, see http://www.gnu.org/licenses/.
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include "../include/ebus/Ebus.h"
 
 #include <bits/types/struct_timespec.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
 #include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
-#include <iomanip>
 #include <map>
-#include <sstream>
+#include <mutex>
 #include <thread>
+#include <type_traits>
 
+#include "../include/ebus/Hex.h"
 #include "Device.h"
+#include "end_of_input.h"
+#include "LogSink.h"
 #include "Notify.h"
 #include "NQueue.h"
 #include "runtime_warning.h"
 #include "Sequence.h"
 #include "Telegram.h"
+#include "TelegramDecoder.h"
 
 #define EBUS_ERR_MASTER       -1 // sending is only as master possible
 #define EBUS_ERR_SEQUENCE     -2 // the passed sequence contains an error
@@ -52,6 +68,13 @@ std::map<int, std::string> EbusErrors =
 namespace ebus
 {
 
+// most detailed level which is compiled in
+#ifdef EBUS_NO_DEBUG_LOG
+static constexpr ebus::LogLevel log_compiled = ebus::LogLevel::info;
+#else
+static constexpr ebus::LogLevel log_compiled = ebus::LogLevel::trace;
+#endif
+
 static const std::string info_dev_open = "device opened";
 static const std::string info_dev_close = "device closed";
 static const std::string info_ebus_lock = "ebus locked";
@@ -60,14 +83,19 @@ static const std::string info_msg_ignore = "message ignored";
 static const std::string info_dev_flush = "device flushed";
 static const std::string info_not_def = "message not defined";
 static const std::string info_no_func = "no function registered";
+static const std::string info_dev_end = "end of device input -> closed";
 
 static const std::string warn_byte_dif = "written/read byte difference";
 static const std::string warn_arb_lost = "arbitration lost";
+static const std::string warn_arb_miss = "send deadline passed -> wait for next SYN";
 static const std::string warn_pri_fit = "priority class fit -> retry";
 static const std::string warn_pri_lost = "priority class lost";
 static const std::string warn_ack_neg = "received acknowledge byte is negative -> retry";
 static const std::string warn_recv_resp = "received response is invalid -> retry";
 static const std::string warn_recv_msg = "message is invalid";
+static const std::string warn_echo_diff = "written/read echo difference -> aborted";
+static const std::string warn_seq_full = "received sequence is too long -> dropped";
+static const std::string warn_tel_trail = "received bytes after the end of the telegram -> ignored";
 
 static const std::string error_open_fail = "opening ebus failed";
 static const std::string error_close_fail = "closing ebus failed";
@@ -78,6 +106,79 @@ static const std::string error_recv_resp = "received response is invalid -> fail
 static const std::string error_resp_crea = "creating response failed";
 static const std::string error_resp_send = "sending response failed";
 static const std::string error_bad_type = "received type does not allow an answer";
+static const std::string error_rt_sched = "setting real-time scheduling failed";
+static const std::string error_rt_cpu = "setting cpu affinity failed";
+static const std::string error_rt_lock = "locking memory failed";
+
+// latest start of the own address byte after its send deadline (one byte at 2400 baud)
+static const long arb_window = 4167L; // us
+
+// window of acknowledge and response bytes (one byte at 2400 baud)
+static const long reply_window = 4167L; // us
+
+// stack pre-faulted by the bus thread
+static const size_t prefault_stack = 64 * 1024;
+
+// transfer tolerance of the device on top of the access timeout
+static const long echo_tolerance = 10000L; // us
+
+static void sleep_until(const std::chrono::steady_clock::time_point &time)
+{
+	// steady_clock is based on CLOCK_MONOTONIC
+	std::chrono::nanoseconds ns = time.time_since_epoch();
+
+	struct timespec req =
+	{ static_cast<time_t>(ns.count() / 1000000000L), static_cast<long>(ns.count() % 1000000000L) };
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &req, nullptr) == EINTR)
+		;
+}
+
+static void prefault()
+{
+	volatile unsigned char stack[prefault_stack];
+
+	for (size_t i = 0; i < prefault_stack; i += 4096)
+		stack[i] = 0;
+
+	(void) stack[0];
+}
+
+// statistics written by the bus thread only and read by others without lock
+struct ArbitrationCounters
+{
+	std::atomic<long> attempts = 0;
+	std::atomic<long> won = 0;
+	std::atomic<long> lost = 0;
+	std::atomic<long> missed = 0;
+	std::atomic<long> timeouts = 0;
+
+	std::atomic<long> send_error_max = 0;
+	std::atomic<long long> send_error_sum = 0;
+	std::atomic<long> echo_delay_min = 0;
+	std::atomic<long> echo_delay_max = 0;
+	std::atomic<long long> echo_delay_sum = 0;
+};
+
+struct TimingCounters
+{
+	std::atomic<long> replies = 0;
+	std::atomic<long> missed = 0;
+	std::atomic<long> delay_max = 0;
+};
+
+// update of a counter with a single writer, no read-modify-write needed
+template<typename T>
+static void store(std::atomic<T> &counter, const T value)
+{
+	counter.store(value, std::memory_order_relaxed);
+}
+
+template<typename T>
+static T load(const std::atomic<T> &counter)
+{
+	return (counter.load(std::memory_order_relaxed));
+}
 
 struct Message : public Notify
 {
@@ -120,6 +221,13 @@ public:
 
 	bool online();
 
+	const DeviceCounters device_counters();
+	const LowLatency low_latency();
+	const ArbitrationStats arbitration_stats();
+	const TimingStats timing_stats();
+	const RealTime realtime();
+	long log_overflows();
+
 	int transmit(const std::vector<std::byte> &message, std::vector<std::byte> &response);
 
 	const std::string error_text(const int error) const;
@@ -130,11 +238,19 @@ public:
 		std::function<Reaction(const std::vector<std::byte> &message, std::vector<std::byte> &response)> process);
 
 	void register_publish(
-		std::function<void(const std::vector<std::byte> &message, const std::vector<std::byte> &response)> publish);
+		std::function<void(const SequenceView &message, const SequenceView &response,
+			const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)> publish);
 
 	void register_rawdata(std::function<void(const std::byte &byte)> rawdata);
 
+	void register_rawdata(std::function<void(const std::byte &byte, const std::chrono::steady_clock::time_point &time)> rawdata);
+
 	void set_access_timeout(const long &access_timeout);
+	void set_arbitration_delay(const long &arbitration_delay);
+	void set_low_latency(const bool &low_latency);
+	void set_pipelined_send(const bool &pipelined_send);
+	void set_realtime(const RealTime &realtime);
+	void set_async_log(const bool &async_log);
 	void set_lock_counter_max(const int &lock_counter_max);
 
 	void set_open_counter_max(const int &open_counter_max);
@@ -154,6 +270,12 @@ private:
 	const std::byte m_slaveAddress;
 
 	long m_access_timeout = 4400L;
+	long m_arbitration_delay = 0L;
+
+	bool m_pipelined_send = false;
+
+	// the adapter arbitrates at the next SYN, its result arrives while monitoring
+	bool m_arbitrating = false;
 
 	int m_lock_counter_max = 5;
 	int m_lock_counter = 0;
@@ -169,19 +291,62 @@ private:
 
 	std::function<Reaction(const std::vector<std::byte> &message, std::vector<std::byte> &response)> m_process;
 
-	std::vector<std::function<void(const std::vector<std::byte> &message, const std::vector<std::byte> &response)>> m_publish;
+	// all publish variants are adapted to views of the telegram bytes
+	std::vector<
+		std::function<void(const SequenceView &message, const SequenceView &response,
+			const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)>> m_publish;
 
 	std::vector<std::function<void(const std::byte &byte)>> m_rawdata;
 
+	std::vector<std::function<void(const std::byte &byte, const std::chrono::steady_clock::time_point &time)>> m_rawdataTime;
+
+	// receive time of the last read byte
+	std::chrono::steady_clock::time_point m_time;
+
+	// receive time of the last SYN (anchor of the arbitration deadlines)
+	std::chrono::steady_clock::time_point m_syn_time;
+
+	ArbitrationCounters m_arbitration;
+	TimingCounters m_timing;
+
+	// real-time profile (applied by the bus thread)
+	RealTime m_realtimeRequest;
+	RealTime m_realtimeState;
+	std::atomic<bool> m_realtimeChanged = false;
+
+	// asynchronous logging (sink is created and removed by the bus thread)
+	std::unique_ptr<LogSink> m_logSink = nullptr;
+	std::atomic<bool> m_asyncLog = false;
+	std::atomic<bool> m_logChanged = false;
+	std::atomic<long> m_logOverflows = 0;
+
+	std::mutex m_realtime_mutex;
+
 	Sequence m_sequence;
+
+	// follows the telegram in m_sequence while monitoring
+	TelegramDecoder m_decoder;
 	std::shared_ptr<Message> m_activeMessage = nullptr;
-	std::shared_ptr<Message> m_passiveMessage = nullptr;
+
+	// response of the own slave address
+	Telegram m_passiveTelegram;
 
 	int transmit(Telegram &tel);
 
 	void read(std::byte &byte, const long sec, const long nsec);
+	bool read(std::byte &byte, Arbitration &result, std::byte &address, const long sec, const long nsec);
 	void write(const std::byte &byte);
 	void write_read(const std::byte &byte, const long sec, const long nsec);
+	bool write_read(const Sequence &seq, const long sec, const long nsec);
+
+	static Sequence transmission(const Sequence &seq, const std::byte crc, const size_t index);
+
+	void count(std::atomic<long> ArbitrationCounters::*counter);
+	void record(const long send_error, const long echo_delay);
+
+	void reply(const std::chrono::steady_clock::time_point &received);
+
+	void applyRealtime();
 
 	void reset();
 
@@ -194,6 +359,7 @@ private:
 	State processMessage();
 	State sendResponse();
 	State lockBus();
+	State arbitrated(const bool won, const std::byte address);
 	State sendMessage();
 	State receiveResponse();
 	State freeBus();
@@ -202,18 +368,156 @@ private:
 
 	Reaction process(const std::vector<std::byte> &message, std::vector<std::byte> &response);
 
-	void publish(const std::vector<std::byte> &message, const std::vector<std::byte> &response);
+	void publish(const Telegram &tel);
+	void publishMonitored();
 
 	void rawdata(const std::byte &byte);
 
-	void logError(const std::string &message);
-	void logWarn(const std::string &message);
-	void logInfo(const std::string &message);
-	void logDebug(const std::string &message);
-	void logTrace(const std::string &message);
+	void applyLog();
+
+	bool logEnabled(const LogLevel level) const;
+	void logMessage(const LogLevel level, const std::string &message);
+	LogRecord* logRecord(const LogLevel level);
+
+	template<LogLevel level, typename Message>
+	void log(const Message &message);
+
+	template<LogLevel level>
+	void log(const char *prefix, const std::byte *data, const size_t size);
+
+	template<LogLevel level>
+	void log(const char *prefix, const long number);
+
+	template<LogLevel level>
+	void log(const char *prefix, const Telegram &tel, const char *suffix, const bool slave_only = false);
+
+	template<typename ... Args>
+	void logError(const Args &... args);
+
+	template<typename ... Args>
+	void logWarn(const Args &... args);
+
+	template<typename ... Args>
+	void logInfo(const Args &... args);
+
+	template<typename ... Args>
+	void logDebug(const Args &... args);
+
+	template<typename ... Args>
+	void logTrace(const Args &... args);
 
 };
 
+// message is a string or a callable returning one, which only runs when the level is enabled
+template<ebus::LogLevel level, typename Message>
+void ebus::Ebus::EbusImpl::log(const Message &message)
+{
+	if constexpr (level <= log_compiled)
+	{
+		if (!logEnabled(level)) return;
+
+		if constexpr (std::is_invocable_v<Message>)
+			logMessage(level, message());
+		else
+			logMessage(level, message);
+	}
+}
+
+// bytes are printed as hex after the prefix
+template<ebus::LogLevel level>
+void ebus::Ebus::EbusImpl::log(const char *prefix, const std::byte *data, const size_t size)
+{
+	if constexpr (level <= log_compiled)
+	{
+		if (!logEnabled(level)) return;
+
+		if (m_logSink == nullptr)
+		{
+			logMessage(level, prefix + Telegram::hex(SequenceView(data, size)));
+			return;
+		}
+
+		LogRecord *record = logRecord(level);
+		if (record == nullptr) return;
+
+		record->set_bytes(prefix, data, size);
+		m_logSink->commit();
+	}
+}
+
+template<ebus::LogLevel level>
+void ebus::Ebus::EbusImpl::log(const char *prefix, const long number)
+{
+	if constexpr (level <= log_compiled)
+	{
+		if (!logEnabled(level)) return;
+
+		if (m_logSink == nullptr)
+		{
+			logMessage(level, prefix + std::to_string(number));
+			return;
+		}
+
+		LogRecord *record = logRecord(level);
+		if (record == nullptr) return;
+
+		record->set_number(prefix, number);
+		m_logSink->commit();
+	}
+}
+
+// telegram (or its slave part only) between prefix and suffix
+template<ebus::LogLevel level>
+void ebus::Ebus::EbusImpl::log(const char *prefix, const Telegram &tel, const char *suffix, const bool slave_only)
+{
+	if constexpr (level <= log_compiled)
+	{
+		if (!logEnabled(level)) return;
+
+		if (m_logSink == nullptr)
+		{
+			logMessage(level, prefix + (slave_only ? tel.toStringSlave() : tel.to_string()) + suffix);
+			return;
+		}
+
+		LogRecord *record = logRecord(level);
+		if (record == nullptr) return;
+
+		record->set_telegram(prefix, tel, suffix, slave_only);
+		m_logSink->commit();
+	}
+}
+
+template<typename ... Args>
+void ebus::Ebus::EbusImpl::logError(const Args &... args)
+{
+	log<LogLevel::error>(args...);
+}
+
+template<typename ... Args>
+void ebus::Ebus::EbusImpl::logWarn(const Args &... args)
+{
+	log<LogLevel::warn>(args...);
+}
+
+template<typename ... Args>
+void ebus::Ebus::EbusImpl::logInfo(const Args &... args)
+{
+	log<LogLevel::info>(args...);
+}
+
+template<typename ... Args>
+void ebus::Ebus::EbusImpl::logDebug(const Args &... args)
+{
+	log<LogLevel::debug>(args...);
+}
+
+template<typename ... Args>
+void ebus::Ebus::EbusImpl::logTrace(const Args &... args)
+{
+	log<LogLevel::trace>(args...);
+}
+
 ebus::Ebus::Ebus(const std::byte address, const std::string &device) : impl
 { std::make_unique<EbusImpl>(address, device) }
 {
@@ -251,6 +555,36 @@ bool ebus::Ebus::online()
 	return (this->impl->online());
 }
 
+const ebus::DeviceCounters ebus::Ebus::device_counters()
+{
+	return (this->impl->device_counters());
+}
+
+const ebus::LowLatency ebus::Ebus::low_latency()
+{
+	return (this->impl->low_latency());
+}
+
+const ebus::ArbitrationStats ebus::Ebus::arbitration_stats()
+{
+	return (this->impl->arbitration_stats());
+}
+
+const ebus::TimingStats ebus::Ebus::timing_stats()
+{
+	return (this->impl->timing_stats());
+}
+
+const ebus::RealTime ebus::Ebus::realtime()
+{
+	return (this->impl->realtime());
+}
+
+long ebus::Ebus::log_overflows()
+{
+	return (this->impl->log_overflows());
+}
+
 int ebus::Ebus::transmit(const std::vector<std::byte> &message, std::vector<std::byte> &response)
 {
 	return (this->impl->transmit(message, response));
@@ -274,6 +608,40 @@ void ebus::Ebus::register_process(
 
 void ebus::Ebus::register_publish(
 	std::function<void(const std::vector<std::byte> &message, const std::vector<std::byte> &response)> publish)
+{
+	this->impl->register_publish(
+		[publish](const SequenceView &message, const SequenceView &response, const std::chrono::steady_clock::time_point&,
+			const std::chrono::steady_clock::time_point&)
+		{
+			publish(message.to_vector(), response.to_vector());
+		});
+}
+
+void ebus::Ebus::register_publish(
+	std::function<void(const std::vector<std::byte> &message, const std::vector<std::byte> &response,
+		const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)> publish)
+{
+	this->impl->register_publish(
+		[publish](const SequenceView &message, const SequenceView &response, const std::chrono::steady_clock::time_point &begin,
+			const std::chrono::steady_clock::time_point &end)
+		{
+			publish(message.to_vector(), response.to_vector(), begin, end);
+		});
+}
+
+void ebus::Ebus::register_publish(std::function<void(const SequenceView &message, const SequenceView &response)> publish)
+{
+	this->impl->register_publish(
+		[publish](const SequenceView &message, const SequenceView &response, const std::chrono::steady_clock::time_point&,
+			const std::chrono::steady_clock::time_point&)
+		{
+			publish(message, response);
+		});
+}
+
+void ebus::Ebus::register_publish(
+	std::function<void(const SequenceView &message, const SequenceView &response,
+		const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)> publish)
 {
 	this->impl->register_publish(publish);
 }
@@ -283,11 +651,42 @@ void ebus::Ebus::register_rawdata(std::function<void(const std::byte &byte)> raw
 	this->impl->register_rawdata(rawdata);
 }
 
+void ebus::Ebus::register_rawdata(
+	std::function<void(const std::byte &byte, const std::chrono::steady_clock::time_point &time)> rawdata)
+{
+	this->impl->register_rawdata(rawdata);
+}
+
 void ebus::Ebus::set_access_timeout(const long &access_timeout)
 {
 	this->impl->set_access_timeout(access_timeout);
 }
 
+void ebus::Ebus::set_arbitration_delay(const long &arbitration_delay)
+{
+	this->impl->set_arbitration_delay(arbitration_delay);
+}
+
+void ebus::Ebus::set_low_latency(const bool &low_latency)
+{
+	this->impl->set_low_latency(low_latency);
+}
+
+void ebus::Ebus::set_pipelined_send(const bool &pipelined_send)
+{
+	this->impl->set_pipelined_send(pipelined_send);
+}
+
+void ebus::Ebus::set_realtime(const RealTime &realtime)
+{
+	this->impl->set_realtime(realtime);
+}
+
+void ebus::Ebus::set_async_log(const bool &async_log)
+{
+	this->impl->set_async_log(async_log);
+}
+
 void ebus::Ebus::set_lock_counter_max(const int &lock_counter_max)
 {
 	this->impl->set_lock_counter_max(lock_counter_max);
@@ -354,6 +753,64 @@ bool ebus::Ebus::EbusImpl::online()
 	return (m_online);
 }
 
+const ebus::DeviceCounters ebus::Ebus::EbusImpl::device_counters()
+{
+	return (m_device->counters());
+}
+
+const ebus::LowLatency ebus::Ebus::EbusImpl::low_latency()
+{
+	return (m_device->lowLatency());
+}
+
+const ebus::ArbitrationStats ebus::Ebus::EbusImpl::arbitration_stats()
+{
+	ArbitrationStats stats;
+
+	stats.attempts = load(m_arbitration.attempts);
+	stats.won = load(m_arbitration.won);
+	stats.lost = load(m_arbitration.lost);
+	stats.missed = load(m_arbitration.missed);
+	stats.timeouts = load(m_arbitration.timeouts);
+
+	stats.send_error_max = load(m_arbitration.send_error_max);
+	stats.echo_delay_min = load(m_arbitration.echo_delay_min);
+	stats.echo_delay_max = load(m_arbitration.echo_delay_max);
+
+	long timed = stats.won + stats.lost;
+
+	if (timed > 0)
+	{
+		stats.send_error_mean = static_cast<double>(load(m_arbitration.send_error_sum)) / timed;
+		stats.echo_delay_mean = static_cast<double>(load(m_arbitration.echo_delay_sum)) / timed;
+	}
+
+	return (stats);
+}
+
+const ebus::TimingStats ebus::Ebus::EbusImpl::timing_stats()
+{
+	TimingStats stats;
+
+	stats.replies = load(m_timing.replies);
+	stats.missed = load(m_timing.missed);
+	stats.delay_max = load(m_timing.delay_max);
+
+	return (stats);
+}
+
+const ebus::RealTime ebus::Ebus::EbusImpl::realtime()
+{
+	std::lock_guard<std::mutex> lock(m_realtime_mutex);
+
+	return (m_realtimeState);
+}
+
+long ebus::Ebus::EbusImpl::log_overflows()
+{
+	return (m_logOverflows);
+}
+
 int ebus::Ebus::EbusImpl::transmit(const std::vector<std::byte> &message, std::vector<std::byte> &response)
 {
 	Telegram tel;
@@ -373,6 +830,7 @@ const std::string ebus::Ebus::EbusImpl::error_text(const int error) const
 void ebus::Ebus::EbusImpl::register_logger(std::shared_ptr<ILogger> logger)
 {
 	m_logger = logger;
+	m_logChanged = true;
 }
 
 void ebus::Ebus::EbusImpl::register_process(
@@ -382,7 +840,8 @@ void ebus::Ebus::EbusImpl::register_process(
 }
 
 void ebus::Ebus::EbusImpl::register_publish(
-	std::function<void(const std::vector<std::byte> &message, const std::vector<std::byte> &response)> publish)
+	std::function<void(const SequenceView &message, const SequenceView &response,
+		const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)> publish)
 {
 	m_publish.push_back(publish);
 }
@@ -392,11 +851,46 @@ void ebus::Ebus::EbusImpl::register_rawdata(std::function<void(const std::byte &
 	m_rawdata.push_back(rawdata);
 }
 
+void ebus::Ebus::EbusImpl::register_rawdata(
+	std::function<void(const std::byte &byte, const std::chrono::steady_clock::time_point &time)> rawdata)
+{
+	m_rawdataTime.push_back(rawdata);
+}
+
 void ebus::Ebus::EbusImpl::set_access_timeout(const long &access_timeout)
 {
 	m_access_timeout = access_timeout;
 }
 
+void ebus::Ebus::EbusImpl::set_arbitration_delay(const long &arbitration_delay)
+{
+	m_arbitration_delay = arbitration_delay;
+}
+
+void ebus::Ebus::EbusImpl::set_low_latency(const bool &low_latency)
+{
+	m_device->setLowLatency(low_latency);
+}
+
+void ebus::Ebus::EbusImpl::set_pipelined_send(const bool &pipelined_send)
+{
+	m_pipelined_send = pipelined_send;
+}
+
+void ebus::Ebus::EbusImpl::set_realtime(const RealTime &realtime)
+{
+	std::lock_guard<std::mutex> lock(m_realtime_mutex);
+
+	m_realtimeRequest = realtime;
+	m_realtimeChanged = true;
+}
+
+void ebus::Ebus::EbusImpl::set_async_log(const bool &async_log)
+{
+	m_asyncLog = async_log;
+	m_logChanged = true;
+}
+
 void ebus::Ebus::EbusImpl::set_lock_counter_max(const int &lock_counter_max)
 {
 	m_lock_counter_max = lock_counter_max;
@@ -414,7 +908,13 @@ const std::vector<std::byte> ebus::Ebus::EbusImpl::range(const std::vector<std::
 
 const std::vector<std::byte> ebus::Ebus::EbusImpl::to_vector(const std::string &str)
 {
-	std::vector<std::byte> result;
+	// a dangling digit is ignored
+	std::vector<std::byte> result(str.size() / 2);
+
+	if (hex::decode(str.data(), result.size() * 2, result.data()) != hex::invalid) return (result);
+
+	// invalid digits are read as far as possible, like strtoul does
+	result.clear();
 
 	for (size_t i = 0; i + 1 < str.size(); i += 2)
 		result.push_back(std::byte(std::strtoul(str.substr(i, 2).c_str(), nullptr, 16)));
@@ -424,12 +924,10 @@ const std::vector<std::byte> ebus::Ebus::EbusImpl::to_vector(const std::string &
 
 const std::string ebus::Ebus::EbusImpl::to_string(const std::vector<std::byte> &vec)
 {
-	std::ostringstream ostr;
-
-	for (size_t i = 0; i < vec.size(); i++)
-		ostr << std::nouppercase << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned>(vec[i]);
+	std::string result(2 * vec.size(), '0');
+	hex::encode(vec.data(), vec.size(), result.data());
 
-	return (ostr.str());
+	return (result);
 }
 
 int ebus::Ebus::EbusImpl::transmit(Telegram &tel)
@@ -463,23 +961,32 @@ int ebus::Ebus::EbusImpl::transmit(Telegram &tel)
 void ebus::Ebus::EbusImpl::read(std::byte &byte, const long sec, const long nsec)
 {
 	m_device->recv(byte, sec, nsec);
+	m_time = m_device->timestamp();
 
 	rawdata(byte);
 
-	std::ostringstream ostr;
-	ostr << std::nouppercase << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned>(byte) << std::nouppercase
-		<< std::setw(0);
-	logTrace("<" + ostr.str());
+	logTrace("<", &byte, 1);
+}
+
+bool ebus::Ebus::EbusImpl::read(std::byte &byte, Arbitration &result, std::byte &address, const long sec, const long nsec)
+{
+	const bool received = m_device->recv(byte, result, address, sec, nsec);
+	m_time = m_device->timestamp();
+
+	if (!received) return (false);
+
+	rawdata(byte);
+
+	logTrace("<", &byte, 1);
+
+	return (true);
 }
 
 void ebus::Ebus::EbusImpl::write(const std::byte &byte)
 {
 	m_device->send(byte);
 
-	std::ostringstream ostr;
-	ostr << std::nouppercase << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned>(byte) << std::nouppercase
-		<< std::setw(0);
-	logTrace(">" + ostr.str());
+	logTrace(">", &byte, 1);
 }
 
 void ebus::Ebus::EbusImpl::write_read(const std::byte &byte, const long sec, const long nsec)
@@ -492,6 +999,129 @@ void ebus::Ebus::EbusImpl::write_read(const std::byte &byte, const long sec, con
 	if (readByte != byte) logDebug(warn_byte_dif);
 }
 
+bool ebus::Ebus::EbusImpl::write_read(const Sequence &seq, const long sec, const long nsec)
+{
+	m_device->send(seq.data(), seq.size());
+
+	logTrace(">", seq.data(), seq.size());
+
+	Sequence echo;
+	std::array<std::byte, Sequence::capacity> bytes;
+
+	m_device->recv(bytes.data(), seq.size(), sec, nsec);
+	m_time = m_device->timestamp();
+
+	for (size_t i = 0; i < seq.size(); i++)
+	{
+		rawdata(bytes[i]);
+		echo.push_back(bytes[i]);
+	}
+
+	logTrace("<", echo.data(), echo.size());
+
+	return (std::equal(echo.data(), echo.data() + echo.size(), seq.data()));
+}
+
+ebus::Sequence ebus::Ebus::EbusImpl::transmission(const Sequence &seq, const std::byte crc, const size_t index)
+{
+	Sequence reduced(seq, 0);
+	reduced.reduce();
+
+	Sequence result;
+
+	for (size_t i = index; i < reduced.size(); i++)
+		result.push_back(reduced[i], false);
+
+	result.push_back(crc, false);
+	result.extend();
+
+	return (result);
+}
+
+void ebus::Ebus::EbusImpl::count(std::atomic<long> ArbitrationCounters::*counter)
+{
+	store(m_arbitration.*counter, load(m_arbitration.*counter) + 1);
+}
+
+void ebus::Ebus::EbusImpl::record(const long send_error, const long echo_delay)
+{
+	if (load(m_arbitration.won) + load(m_arbitration.lost) == 0 || echo_delay < load(m_arbitration.echo_delay_min))
+		store(m_arbitration.echo_delay_min, echo_delay);
+
+	store(m_arbitration.echo_delay_max, std::max(load(m_arbitration.echo_delay_max), echo_delay));
+	store(m_arbitration.send_error_max, std::max(load(m_arbitration.send_error_max), send_error));
+
+	store(m_arbitration.send_error_sum, load(m_arbitration.send_error_sum) + send_error);
+	store(m_arbitration.echo_delay_sum, load(m_arbitration.echo_delay_sum) + echo_delay);
+}
+
+void ebus::Ebus::EbusImpl::reply(const std::chrono::steady_clock::time_point &received)
+{
+	long delay = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - received).count();
+
+	store(m_timing.replies, load(m_timing.replies) + 1);
+	if (delay > reply_window) store(m_timing.missed, load(m_timing.missed) + 1);
+
+	store(m_timing.delay_max, std::max(load(m_timing.delay_max), delay));
+}
+
+void ebus::Ebus::EbusImpl::applyRealtime()
+{
+	m_realtimeChanged = false;
+
+	RealTime request;
+
+	{
+		std::lock_guard<std::mutex> lock(m_realtime_mutex);
+		request = m_realtimeRequest;
+	}
+
+	RealTime state;
+
+	struct sched_param param = {};
+	param.sched_priority = request.priority;
+
+	if (pthread_setschedparam(pthread_self(), request.priority > 0 ? SCHED_FIFO : SCHED_OTHER, &param) == 0)
+		state.priority = request.priority;
+	else
+		logWarn(error_rt_sched);
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+
+	if (request.cpu >= 0)
+		CPU_SET(request.cpu, &cpus);
+	else
+		for (long i = 0; i < sysconf(_SC_NPROCESSORS_CONF) && i < CPU_SETSIZE; i++)
+			CPU_SET(i, &cpus);
+
+	if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0)
+		state.cpu = request.cpu;
+	else
+		logWarn(error_rt_cpu);
+
+	if (request.lock_memory)
+	{
+		// later allocations are locked as well, the stack is touched once
+		if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+		{
+			prefault();
+			state.lock_memory = true;
+		}
+		else
+		{
+			logWarn(error_rt_lock);
+		}
+	}
+	else if (m_realtimeState.lock_memory)
+	{
+		munlockall();
+	}
+
+	std::lock_guard<std::mutex> lock(m_realtime_mutex);
+	m_realtimeState = state;
+}
+
 void ebus::Ebus::EbusImpl::reset()
 {
 	m_open_counter = 0;
@@ -499,29 +1129,32 @@ void ebus::Ebus::EbusImpl::reset()
 
 	m_sequence.clear();
 
-	if (m_activeMessage != nullptr)
+	// a message waiting for the arbitration of the adapter stays active
+	if (m_activeMessage != nullptr && !m_arbitrating)
 	{
-		publish(m_activeMessage->m_telegram.getMaster().get_sequence(), m_activeMessage->m_telegram.getSlave().get_sequence());
+		Telegram &tel = m_activeMessage->m_telegram;
+		tel.setTime(tel.getBeginTime(), m_time);
+
+		publish(tel);
 
 		m_activeMessage->notify();
 		m_activeMessage = nullptr;
 	}
 
-	if (m_passiveMessage != nullptr)
-	{
-		std::shared_ptr<Message> message = m_passiveMessage;
-		m_passiveMessage = nullptr;
-	}
+	m_passiveTelegram.clear();
 }
 
 void ebus::Ebus::EbusImpl::run()
 {
 	logInfo("Ebus started");
 
-	State state = State::OpenDevice;
+	State state = m_device->explicitOpen() ? State::IdleSystem : State::OpenDevice;
 
 	while (m_running)
 	{
+		if (m_realtimeChanged) applyRealtime();
+		if (m_logChanged) applyLog();
+
 		try
 		{
 			switch (state)
@@ -559,6 +1192,15 @@ void ebus::Ebus::EbusImpl::run()
 			default:
 				break;
 			}
+		} catch (const ebus::end_of_input &ex)
+		{
+			// replayed data is exhausted: go idle until reopened
+			if (m_activeMessage != nullptr) m_activeMessage->m_state = EBUS_ERR_DEVICE;
+
+			logInfo(ex.what());
+			logInfo(info_dev_end);
+
+			m_close = true;
 		} catch (const ebus::runtime_warning &ex)
 		{
 			state = handleDeviceError(false, ex.what());
@@ -621,6 +1263,9 @@ ebus::State ebus::Ebus::EbusImpl::openDevice()
 
 	logInfo(info_dev_open);
 
+	// a requested arbitration ended with the reset of the adapter
+	m_arbitrating = false;
+
 	do
 	{
 		read(byte, 1, 0);
@@ -641,29 +1286,51 @@ ebus::State ebus::Ebus::EbusImpl::monitorBus()
 
 	std::byte byte = seq_zero;
 
-	read(byte, 1, 0);
+	if (m_arbitrating)
+	{
+		// bytes of other masters received before the result of the adapter are monitored
+		Arbitration result;
+		std::byte address;
+
+		if (!read(byte, result, address, 1, 0))
+		{
+			m_arbitrating = false;
+			return (arbitrated(result == Arbitration::won, address));
+		}
+	}
+	else
+	{
+		read(byte, 1, 0);
+	}
 
 	if (byte == seq_syn)
 	{
+		m_syn_time = m_time;
+
 		if (m_lock_counter != 0)
 		{
 			m_lock_counter--;
-			logDebug("m_lock_counter: " + std::to_string(m_lock_counter));
+			logDebug("m_lock_counter: ", m_lock_counter);
 		}
 
 		// decode Sequence
 		if (m_sequence.size() != 0)
 		{
-			logDebug(m_sequence.to_string());
-// TODO new decoding
-			Telegram tel(m_sequence);
-			logInfo(tel.to_string());
+			logDebug("", m_sequence.data(), m_sequence.size());
 
-			if (tel.isValid()) publish(tel.getMaster().get_sequence(), tel.getSlave().get_sequence());
+			// the telegram was published with its last byte, incomplete and broken ones are decoded as a whole
+			if (m_decoder.state() == TelegramDecoder::State::trailing)
+			{
+				logWarn(warn_tel_trail);
+				logDebug("", m_decoder.data() + m_decoder.length(), m_decoder.size() - m_decoder.length());
+			}
+			else if (m_decoder.state() != TelegramDecoder::State::complete)
+			{
+				publishMonitored();
+			}
 
 			if (m_sequence.size() == 1 && m_lock_counter < 2) m_lock_counter = 2;
 
-			tel.clear();
 			m_sequence.clear();
 		}
 
@@ -671,11 +1338,23 @@ ebus::State ebus::Ebus::EbusImpl::monitorBus()
 		if (m_activeMessage == nullptr && m_messageQueue.size() > 0) m_activeMessage = m_messageQueue.dequeue();
 
 		// handle Message
-		if (m_activeMessage != nullptr && m_lock_counter == 0) return (State::LockBus);
+		if (m_activeMessage != nullptr && m_lock_counter == 0 && !m_arbitrating) return (State::LockBus);
 	}
 	else
 	{
-		m_sequence.push_back(byte);
+		// no SYN for a long time: drop the collected bytes
+		if (m_sequence.size() == Sequence::capacity)
+		{
+			logWarn(warn_seq_full);
+			m_sequence.clear();
+		}
+
+		if (m_sequence.size() == 0) m_decoder.reset();
+
+		m_sequence.push_back(byte, m_time);
+
+		// a telegram is published with its last byte
+		if (m_decoder.feed(byte)) publishMonitored();
 
 		// handle broadcast and at me addressed messages
 		if (m_sequence.size() == 2
@@ -700,7 +1379,7 @@ ebus::State ebus::Ebus::EbusImpl::receiveMessage()
 
 		read(byte, 1, 0);
 
-		m_sequence.push_back(byte);
+		m_sequence.push_back(byte, m_time);
 	}
 
 	// maximum data bytes
@@ -724,32 +1403,33 @@ ebus::State ebus::Ebus::EbusImpl::receiveMessage()
 
 		read(byte, 1, 0);
 
-		m_sequence.push_back(byte);
+		m_sequence.push_back(byte, m_time);
 
 		if (byte == seq_exp) bytes++;
 	}
 
-	// 1 for CRC
-	bytes = 1;
+	// running CRC of the received bytes
+	const std::byte crc = m_sequence.crc();
+
+	EscapeDecoder decoder;
+	std::byte received = seq_zero;
 
 	// receive CRC
-	for (int i = 0; i < bytes; i++)
+	do
 	{
 		read(byte, 1, 0);
 
-		m_sequence.push_back(byte);
+		m_sequence.push_back(byte, m_time);
+	} while (!decoder.feed(byte, received));
 
-		if (byte == seq_exp) bytes++;
-	}
+	logDebug("", m_sequence.data(), m_sequence.size());
 
-	logDebug(m_sequence.to_string());
-// TODO check CRC of sequence
 	Telegram tel;
 	tel.createMaster(m_sequence);
 
 	if (m_sequence[1] != seq_broad)
 	{
-		if (tel.getMasterState() == SEQ_OK)
+		if (received == crc && tel.getMasterState() == SEQ_OK)
 		{
 			byte = seq_ack;
 		}
@@ -760,6 +1440,7 @@ ebus::State ebus::Ebus::EbusImpl::receiveMessage()
 		}
 
 		// send ACK
+		reply(m_time);
 		write_read(byte, 0, 0);
 
 		tel.setSlaveACK(byte);
@@ -769,8 +1450,10 @@ ebus::State ebus::Ebus::EbusImpl::receiveMessage()
 	{
 		if (tel.get_type() != Type::MS)
 		{
-			logInfo(tel.to_string());
-			publish(tel.getMaster().get_sequence(), tel.getSlave().get_sequence());
+			logInfo("", tel, "");
+
+			tel.setTime(m_sequence.begin_time(), m_time);
+			publish(tel);
 		}
 
 		return (State::ProcessMessage);
@@ -785,8 +1468,10 @@ ebus::State ebus::Ebus::EbusImpl::processMessage()
 {
 	logDebug("processMessage");
 
-	Telegram tel;
+	Telegram &tel = m_passiveTelegram;
+	tel.clear();
 	tel.createMaster(m_sequence);
+	tel.setTime(m_sequence.begin_time(), m_time);
 
 	std::vector<std::byte> response;
 
@@ -810,8 +1495,7 @@ ebus::State ebus::Ebus::EbusImpl::processMessage()
 
 			if (tel.getSlaveState() == SEQ_OK)
 			{
-				logInfo("response: " + tel.toStringSlave());
-				m_passiveMessage = std::make_shared<Message>(tel);
+				logInfo("response: ", tel, "", true);
 
 				return (State::SendResponse);
 			}
@@ -839,19 +1523,35 @@ ebus::State ebus::Ebus::EbusImpl::sendResponse()
 {
 	logDebug("sendResponse");
 
-	Telegram &tel = m_passiveMessage->m_telegram;
+	Telegram &tel = m_passiveTelegram;
 	std::byte byte;
 
-// TODO expand, calc CRC of sequence and send
+	// response follows the acknowledge of the request
+	reply(m_time);
 
 	for (int retry = 1; retry >= 0; retry--)
 	{
-		// send Message
-		for (size_t i = 0; i < tel.getSlave().size(); i++)
-			write_read(tel.getSlave()[i], 0, 0);
+		// extended response and CRC
+		const Sequence data = transmission(tel.getSlave(), tel.getSlaveCRC(), 0);
+
+		if (m_pipelined_send)
+		{
+			// send Message and CRC at once
+			if (!write_read(data, 1, 0))
+			{
+				logWarn(warn_echo_diff);
 
-		// send CRC
-		write_read(tel.getSlaveCRC(), 0, 0);
+				reset();
+
+				return (State::MonitorBus);
+			}
+		}
+		else
+		{
+			// send Message and CRC
+			for (size_t i = 0; i < data.size(); i++)
+				write_read(data[i], 0, 0);
+		}
 
 		// receive ACK
 		read(byte, 0, 10000L);
@@ -881,8 +1581,10 @@ ebus::State ebus::Ebus::EbusImpl::sendResponse()
 
 	tel.setMasterACK(byte);
 
-	logInfo(tel.to_string());
-	publish(tel.getMaster().get_sequence(), tel.getSlave().get_sequence());
+	logInfo("", tel, "");
+
+	tel.setTime(tel.getBeginTime(), m_time);
+	publish(tel);
 
 	reset();
 
@@ -896,21 +1598,67 @@ ebus::State ebus::Ebus::EbusImpl::lockBus()
 	Telegram &tel = m_activeMessage->m_telegram;
 	std::byte byte = tel.getMasterQQ();
 
-	write(byte);
+	if (m_device->hasArbitration())
+	{
+		// adapter arbitrates at the next free SYN and reports the address byte seen on the bus
+		m_device->arbitrate(byte);
+		count(&ArbitrationCounters::attempts);
 
-	struct timespec req =
-	{ 0, m_access_timeout * 1000L };
-	nanosleep(&req, (struct timespec*) NULL);
+		m_arbitrating = true;
 
-	byte = seq_zero;
+		return (State::MonitorBus);
+	}
+	else
+	{
+		// address byte goes out at a fixed offset after SYN, the echo is expected until a deadline
+		const std::chrono::steady_clock::time_point send = m_syn_time + std::chrono::microseconds(m_arbitration_delay);
+		const std::chrono::steady_clock::time_point echo = send + std::chrono::microseconds(m_access_timeout + echo_tolerance);
+
+		// the bus has already moved on
+		if (m_device->available() || std::chrono::steady_clock::now() > send + std::chrono::microseconds(arb_window))
+		{
+			count(&ArbitrationCounters::missed);
+			logDebug(warn_arb_miss);
 
-	read(byte, 0, 10000L);
+			return (State::MonitorBus);
+		}
+
+		sleep_until(send);
+
+		write(byte);
+		count(&ArbitrationCounters::attempts);
+
+		const std::chrono::steady_clock::time_point sent = std::chrono::steady_clock::now();
+
+		byte = seq_zero;
+
+		try
+		{
+			long remaining = std::chrono::duration_cast<std::chrono::microseconds>(echo - sent).count();
+			read(byte, 0, std::max(remaining, 1L));
+		} catch (const ebus::runtime_warning&)
+		{
+			count(&ArbitrationCounters::timeouts);
+			throw;
+		}
+
+		record(std::chrono::duration_cast<std::chrono::microseconds>(sent - send).count(),
+			std::chrono::duration_cast<std::chrono::microseconds>(m_time - sent).count());
+	}
 
-	if (byte != tel.getMasterQQ())
+	return (arbitrated(byte == tel.getMasterQQ(), byte));
+}
+
+ebus::State ebus::Ebus::EbusImpl::arbitrated(const bool won, const std::byte address)
+{
+	Telegram &tel = m_activeMessage->m_telegram;
+
+	if (!won)
 	{
+		count(&ArbitrationCounters::lost);
 		logDebug(warn_arb_lost);
 
-		if ((byte & std::byte(0x0f)) != (tel.getMasterQQ() & std::byte(0x0f)))
+		if ((address & std::byte(0x0f)) != (tel.getMasterQQ() & std::byte(0x0f)))
 		{
 			m_lock_counter = m_lock_counter_max;
 			logDebug(warn_pri_lost);
@@ -924,6 +1672,11 @@ ebus::State ebus::Ebus::EbusImpl::lockBus()
 		return (State::MonitorBus);
 	}
 
+	count(&ArbitrationCounters::won);
+
+	// telegram begins with the echo of the own address
+	tel.setTime(m_time, m_time);
+
 	logDebug(info_ebus_lock);
 
 	return (State::SendMessage);
@@ -935,21 +1688,33 @@ ebus::State ebus::Ebus::EbusImpl::sendMessage()
 
 	Telegram &tel = m_activeMessage->m_telegram;
 
-// TODO expand, calc CRC of sequence and send
-
 	for (int retry = 1; retry >= 0; retry--)
 	{
-		// send Message
-		for (size_t i = retry; i < tel.getMaster().size(); i++)
-			write_read(tel.getMaster()[i], 0, 0);
+		// extended message and CRC (QQ was sent by lockBus)
+		const Sequence data = transmission(tel.getMaster(), tel.getMasterCRC(), retry);
 
-		// send CRC
-		write_read(tel.getMasterCRC(), 0, 0);
+		if (m_pipelined_send)
+		{
+			// send Message and CRC at once
+			if (!write_read(data, 1, 0))
+			{
+				logWarn(warn_echo_diff);
+				m_activeMessage->m_state = EBUS_ERR_TRANSMIT;
+
+				return (State::FreeBus);
+			}
+		}
+		else
+		{
+			// send Message and CRC
+			for (size_t i = 0; i < data.size(); i++)
+				write_read(data[i], 0, 0);
+		}
 
 		// Broadcast ends here
 		if (tel.get_type() == Type::BC)
 		{
-			logInfo(tel.to_string() + " transmitted");
+			logInfo("", tel, " transmitted");
 			return (State::FreeBus);
 		}
 
@@ -972,7 +1737,7 @@ ebus::State ebus::Ebus::EbusImpl::sendMessage()
 			// Master Master ends here
 			if (tel.get_type() == Type::MM)
 			{
-				logInfo(tel.to_string() + " transmitted");
+				logInfo("", tel, " transmitted");
 				return (State::FreeBus);
 			}
 			else
@@ -1023,8 +1788,7 @@ ebus::State ebus::Ebus::EbusImpl::receiveResponse()
 
 		seq.push_back(byte);
 
-		// +1 for CRC
-		size_t bytes = std::to_integer<size_t>(byte) + 1;
+		size_t bytes = std::to_integer<size_t>(byte);
 
 		for (size_t i = 0; i < bytes; i++)
 		{
@@ -1034,23 +1798,38 @@ ebus::State ebus::Ebus::EbusImpl::receiveResponse()
 
 			if (byte == seq_exp) bytes++;
 		}
-// TODO check CRC of sequence
+
+		// running CRC of the received bytes
+		const std::byte crc = seq.crc();
+
+		EscapeDecoder decoder;
+		std::byte received = seq_zero;
+
+		// receive CRC
+		do
+		{
+			read(byte, 1, 0);
+
+			seq.push_back(byte);
+		} while (!decoder.feed(byte, received));
+
 		// create slave data
 		tel.createSlave(seq);
 
-		if (tel.getSlaveState() == SEQ_OK)
+		if (received == crc && tel.getSlaveState() == SEQ_OK)
 			byte = seq_ack;
 		else
 			byte = seq_nak;
 
 		// send ACK
+		reply(m_time);
 		write_read(byte, 0, 0);
 
 		tel.setMasterACK(byte);
 
 		if (tel.getSlaveState() == SEQ_OK)
 		{
-			logInfo(tel.to_string() + " transmitted");
+			logInfo("", tel, " transmitted");
 			break;
 		}
 
@@ -1113,15 +1892,29 @@ ebus::Reaction ebus::Ebus::EbusImpl::process(const std::vector<std::byte> &messa
 		return (Reaction::nofunction);
 }
 
-void ebus::Ebus::EbusImpl::publish(const std::vector<std::byte> &message, const std::vector<std::byte> &response)
+void ebus::Ebus::EbusImpl::publish(const Telegram &tel)
 {
 	if (!m_publish.empty())
 	{
+		const SequenceView message = tel.getMasterView();
+		const SequenceView response = tel.getSlaveView();
+
 		for (const auto &publish : m_publish)
-			publish(message, response);
+			publish(message, response, tel.getBeginTime(), tel.getEndTime());
 	}
 }
 
+void ebus::Ebus::EbusImpl::publishMonitored()
+{
+	// master and slave stay offsets into the decoder until they are needed
+	Telegram tel;
+	tel.parse(m_decoder.data(), m_decoder.size());
+	tel.setTime(m_sequence.begin_time(), m_sequence.end_time());
+	logInfo("", tel, "");
+
+	if (tel.isValid()) publish(tel);
+}
+
 void ebus::Ebus::EbusImpl::rawdata(const std::byte &byte)
 {
 	if (!m_rawdata.empty())
@@ -1129,29 +1922,56 @@ void ebus::Ebus::EbusImpl::rawdata(const std::byte &byte)
 		for (const auto &rawdata : m_rawdata)
 			rawdata(byte);
 	}
-}
 
-void ebus::Ebus::EbusImpl::logError(const std::string &message)
-{
-	if (m_logger != nullptr) m_logger->error(message);
+	if (!m_rawdataTime.empty())
+	{
+		for (const auto &rawdata : m_rawdataTime)
+			rawdata(byte, m_time);
+	}
 }
 
-void ebus::Ebus::EbusImpl::logWarn(const std::string &message)
+void ebus::Ebus::EbusImpl::applyLog()
 {
-	if (m_logger != nullptr) m_logger->warn(message);
+	m_logChanged = false;
+
+	// a replaced sink forwards its pending records before it is removed
+	m_logSink.reset();
+
+	if (m_asyncLog && m_logger != nullptr) m_logSink = std::make_unique<LogSink>(m_logger);
 }
 
-void ebus::Ebus::EbusImpl::logInfo(const std::string &message)
+bool ebus::Ebus::EbusImpl::logEnabled(const LogLevel level) const
 {
-	if (m_logger != nullptr) m_logger->info(message);
+	return (m_logger != nullptr && level <= m_logger->level());
 }
 
-void ebus::Ebus::EbusImpl::logDebug(const std::string &message)
+void ebus::Ebus::EbusImpl::logMessage(const LogLevel level, const std::string &message)
 {
-	if (m_logger != nullptr) m_logger->debug(message);
+	if (m_logSink == nullptr)
+	{
+		m_logger->log(level, std::chrono::steady_clock::now(), message);
+		return;
+	}
+
+	LogRecord *record = logRecord(level);
+	if (record == nullptr) return;
+
+	record->set_text(message.data(), message.size());
+	m_logSink->commit();
 }
 
-void ebus::Ebus::EbusImpl::logTrace(const std::string &message)
+ebus::LogRecord* ebus::Ebus::EbusImpl::logRecord(const LogLevel level)
 {
-	if (m_logger != nullptr) m_logger->trace(message);
+	LogRecord *record = m_logSink->claim();
+
+	if (record == nullptr)
+	{
+		m_logOverflows++;
+		return (nullptr);
+	}
+
+	record->level = level;
+	record->time = std::chrono::steady_clock::now();
+
+	return (record);
 }
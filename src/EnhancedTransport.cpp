@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "EnhancedTransport.h"
+
+#include <poll.h>
+#include <cerrno>
+#include <stdexcept>
+
+#include "runtime_warning.h"
+
+ebus::EnhancedTransport::EnhancedTransport(std::unique_ptr<Transport> transport) : m_transport(std::move(transport))
+{
+}
+
+void ebus::EnhancedTransport::open()
+{
+	m_transport->open();
+
+	m_pending = false;
+	m_error = 0;
+	m_result = Arbitration::pending;
+
+	// reset adapter without additional features
+	request(enh_req_init, std::byte(0x00));
+}
+
+void ebus::EnhancedTransport::close()
+{
+	m_transport->close();
+}
+
+int ebus::EnhancedTransport::fd() const
+{
+	return (m_transport->fd());
+}
+
+int ebus::EnhancedTransport::poll(const short events, const struct timespec *timeout, short &revents)
+{
+	return (m_transport->poll(events, timeout, revents));
+}
+
+ssize_t ebus::EnhancedTransport::read(std::byte *data, const size_t size)
+{
+	m_raw.resize(size);
+
+	ssize_t nbytes = m_transport->read(m_raw.data(), m_raw.size());
+	if (nbytes <= 0) return (nbytes);
+
+	size_t count = 0;
+
+	for (ssize_t i = 0; i < nbytes; i++)
+	{
+		const std::byte byte = m_raw[i];
+
+		if (m_pending && (byte & std::byte(0xc0)) == std::byte(0x80))
+		{
+			m_pending = false;
+
+			const int command = std::to_integer<int>(m_first >> 2) & 0x0f;
+			const std::byte value = ((m_first & std::byte(0x03)) << 6) | (byte & std::byte(0x3f));
+
+			switch (command)
+			{
+			case enh_res_received:
+				data[count++] = value;
+				break;
+			case enh_res_started:
+				m_result = Arbitration::won;
+				m_resultAddress = value;
+				break;
+			case enh_res_failed:
+				// the address of the winner is the first byte of its telegram
+				m_result = Arbitration::lost;
+				m_resultAddress = value;
+				data[count++] = value;
+				break;
+			case enh_res_error_ebus:
+			case enh_res_error_host:
+				m_error = command;
+				break;
+			case enh_res_resetted:
+			case enh_res_info:
+			default:
+				break;
+			}
+		}
+		else if ((byte & std::byte(0xc0)) == std::byte(0xc0))
+		{
+			m_pending = true;
+			m_first = byte;
+		}
+		else if ((byte & std::byte(0x80)) == std::byte(0x00))
+		{
+			// received data bytes below 0x80 are transferred without framing
+			m_pending = false;
+			data[count++] = byte;
+		}
+		else
+		{
+			// second frame byte without first one
+			m_pending = false;
+		}
+	}
+
+	if (count == 0 && m_error != 0)
+	{
+		int error = m_error;
+		m_error = 0;
+
+		if (error == enh_res_error_ebus)
+			throw ebus::runtime_warning("The enhanced adapter reported an ebus error");
+		else
+			throw ebus::runtime_warning("The enhanced adapter reported a host error");
+	}
+
+	// only control frames received
+	if (count == 0)
+	{
+		errno = EAGAIN;
+		return (-1);
+	}
+
+	return (count);
+}
+
+ssize_t ebus::EnhancedTransport::write(const std::byte *data, const size_t size)
+{
+	m_frames.resize(size * 2);
+
+	for (size_t i = 0; i < size; i++)
+		encode(enh_req_send, data[i], &m_frames[i * 2]);
+
+	writeAll(m_frames.data(), m_frames.size());
+
+	return (size);
+}
+
+bool ebus::EnhancedTransport::timestamp(std::chrono::steady_clock::time_point &time)
+{
+	return (m_transport->timestamp(time));
+}
+
+bool ebus::EnhancedTransport::check(DeviceCounters &counters)
+{
+	return (m_transport->check(counters));
+}
+
+void ebus::EnhancedTransport::lowLatency(const bool enable, LowLatency &state)
+{
+	m_transport->lowLatency(enable, state);
+}
+
+bool ebus::EnhancedTransport::arbitration() const
+{
+	return (true);
+}
+
+void ebus::EnhancedTransport::arbitrate(const std::byte address)
+{
+	m_result = Arbitration::pending;
+	request(enh_req_start, address);
+}
+
+ebus::Arbitration ebus::EnhancedTransport::arbitrationResult(std::byte &address)
+{
+	const Arbitration result = m_result;
+
+	address = m_resultAddress;
+	m_result = Arbitration::pending;
+
+	return (result);
+}
+
+void ebus::EnhancedTransport::encode(const int command, const std::byte data, std::byte *frame)
+{
+	frame[0] = std::byte(0xc0 | ((command & 0x0f) << 2)) | (data >> 6);
+	frame[1] = std::byte(0x80) | (data & std::byte(0x3f));
+}
+
+void ebus::EnhancedTransport::request(const int command, const std::byte data)
+{
+	std::byte frame[2];
+	encode(command, data, frame);
+
+	writeAll(frame, sizeof(frame));
+}
+
+void ebus::EnhancedTransport::writeAll(const std::byte *data, const size_t size)
+{
+	size_t written = 0;
+
+	while (written < size)
+	{
+		ssize_t ret = m_transport->write(data + written, size - written);
+
+		if (ret > 0)
+		{
+			written += ret;
+		}
+		else if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+		{
+			short revents = 0;
+			m_transport->poll(POLLOUT, nullptr, revents);
+		}
+		else
+		{
+			throw std::runtime_error("An device error occurred while sending data");
+		}
+	}
+}
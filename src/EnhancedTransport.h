@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_ENHANCEDTRANSPORT_H
+#define EBUS_ENHANCEDTRANSPORT_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "Transport.h"
+
+namespace ebus
+{
+
+// enhanced adapter protocol: 2 byte frames 11ccccdd 10dddddd (c = command, d = data)
+static const int enh_req_init = 0x0;      // host: initialize adapter
+static const int enh_req_send = 0x1;      // host: send data byte
+static const int enh_req_start = 0x2;     // host: start arbitration with address
+static const int enh_req_info = 0x3;      // host: request adapter information
+
+static const int enh_res_resetted = 0x0;  // adapter: reset done
+static const int enh_res_received = 0x1;  // adapter: data byte received
+static const int enh_res_started = 0x2;   // adapter: arbitration won
+static const int enh_res_info = 0x3;      // adapter: information
+static const int enh_res_failed = 0xa;    // adapter: arbitration lost
+static const int enh_res_error_ebus = 0xb; // adapter: ebus error
+static const int enh_res_error_host = 0xc; // adapter: host error
+
+class EnhancedTransport : public Transport
+{
+
+public:
+	explicit EnhancedTransport(std::unique_ptr<Transport> transport);
+
+	void open() override;
+	void close() override;
+
+	int fd() const override;
+
+	int poll(const short events, const struct timespec *timeout, short &revents) override;
+
+	ssize_t read(std::byte *data, const size_t size) override;
+	ssize_t write(const std::byte *data, const size_t size) override;
+
+	bool timestamp(std::chrono::steady_clock::time_point &time) override;
+
+	bool check(DeviceCounters &counters) override;
+
+	void lowLatency(const bool enable, LowLatency &state) override;
+
+	bool arbitration() const override;
+	void arbitrate(const std::byte address) override;
+	Arbitration arbitrationResult(std::byte &address) override;
+
+	static void encode(const int command, const std::byte data, std::byte *frame);
+
+private:
+	std::unique_ptr<Transport> m_transport;
+
+	std::vector<std::byte> m_raw;
+	std::vector<std::byte> m_frames;
+
+	bool m_pending = false;
+	std::byte m_first = std::byte(0x00);
+
+	int m_error = 0;
+
+	// STARTED and FAILED are kept apart from the received bytes
+	Arbitration m_result = Arbitration::pending;
+	std::byte m_resultAddress = std::byte(0x00);
+
+	void request(const int command, const std::byte data);
+
+	void writeAll(const std::byte *data, const size_t size);
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_ENHANCEDTRANSPORT_H
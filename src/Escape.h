@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_ESCAPE_H
+#define EBUS_ESCAPE_H
+
+#include <cstddef>
+
+#include "../include/ebus/Protocol.h"
+
+namespace ebus
+{
+
+static constexpr std::byte seq_zero = std::byte(0x00); // zero byte
+
+// protocol symbols as defined in Protocol.h
+static constexpr std::byte seq_syn = protocol::sym_syn;
+static constexpr std::byte seq_exp = protocol::sym_exp;
+static constexpr std::byte seq_synexp = protocol::sym_synexp;
+static constexpr std::byte seq_expexp = protocol::sym_expexp;
+
+// escaping of SYN and EXP: SYN -> EXP SYNEXP, EXP -> EXP EXPEXP
+class EscapeEncoder
+{
+
+public:
+	// writes the one or two extended bytes of a reduced byte
+	static size_t encode(const std::byte byte, std::byte *out)
+	{
+		if (byte == seq_syn)
+		{
+			out[0] = seq_exp;
+			out[1] = seq_synexp;
+			return (2);
+		}
+
+		if (byte == seq_exp)
+		{
+			out[0] = seq_exp;
+			out[1] = seq_expexp;
+			return (2);
+		}
+
+		out[0] = byte;
+		return (1);
+	}
+
+	// out must not overlap with in
+	static size_t encode(const std::byte *in, const size_t size, std::byte *out)
+	{
+		size_t pos = 0;
+
+		for (size_t i = 0; i < size; i++)
+			pos += encode(in[i], out + pos);
+
+		return (pos);
+	}
+
+	static size_t encoded_size(const std::byte *in, const size_t size)
+	{
+		size_t count = size;
+
+		for (size_t i = 0; i < size; i++)
+			if (in[i] == seq_syn || in[i] == seq_exp) count++;
+
+		return (count);
+	}
+
+};
+
+// byte-at-a-time unescaping state machine
+class EscapeDecoder
+{
+
+public:
+	// returns true when a reduced byte is complete
+	bool feed(const std::byte byte, std::byte &out)
+	{
+		if (m_escape)
+		{
+			m_escape = false;
+			out = (byte == seq_synexp ? seq_syn : seq_exp);
+			return (true);
+		}
+
+		if (byte == seq_syn || byte == seq_exp)
+		{
+			m_escape = true;
+			return (false);
+		}
+
+		out = byte;
+		return (true);
+	}
+
+	// an escape byte waits for its second byte
+	bool pending() const
+	{
+		return (m_escape);
+	}
+
+	void reset()
+	{
+		m_escape = false;
+	}
+
+	// out may be equal to in (decoding in place)
+	static size_t decode(const std::byte *in, const size_t size, std::byte *out)
+	{
+		EscapeDecoder decoder;
+		size_t pos = 0;
+
+		for (size_t i = 0; i < size; i++)
+			if (decoder.feed(in[i], out[pos])) pos++;
+
+		return (pos);
+	}
+
+	static size_t decoded_size(const std::byte *in, const size_t size)
+	{
+		EscapeDecoder decoder;
+		std::byte byte;
+		size_t count = 0;
+
+		for (size_t i = 0; i < size; i++)
+			if (decoder.feed(in[i], byte)) count++;
+
+		return (count);
+	}
+
+private:
+	bool m_escape = false;
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_ESCAPE_H
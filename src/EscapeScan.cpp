@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "EscapeScan.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "Escape.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EBUS_X86 1
+#endif
+
+// classification of 64 byte words: bit i of syn[w] / exp[w] is set when data[64 * w + i] is SYN / EXP
+typedef void (*classify_t)(const std::byte *data, const size_t words, std::uint64_t *syn, std::uint64_t *exp);
+
+// 4 KiB are classified at once, the bitmaps stay in the L1 cache
+static const size_t chunk_words = 64;
+
+static void classify_scalar(const std::byte *data, const size_t words, std::uint64_t *syn, std::uint64_t *exp)
+{
+	for (size_t w = 0; w < words; w++)
+	{
+		std::uint64_t s = 0;
+		std::uint64_t e = 0;
+
+		for (size_t i = 0; i < 64; i++)
+		{
+			s |= std::uint64_t(data[64 * w + i] == ebus::seq_syn) << i;
+			e |= std::uint64_t(data[64 * w + i] == ebus::seq_exp) << i;
+		}
+
+		syn[w] = s;
+		exp[w] = e;
+	}
+}
+
+#ifdef EBUS_X86
+
+__attribute__((target("sse2"))) static void classify_sse2(const std::byte *data, const size_t words, std::uint64_t *syn,
+	std::uint64_t *exp)
+{
+	const __m128i vsyn = _mm_set1_epi8(char(0xaa));
+	const __m128i vexp = _mm_set1_epi8(char(0xa9));
+
+	for (size_t w = 0; w < words; w++)
+	{
+		std::uint64_t s = 0;
+		std::uint64_t e = 0;
+
+		for (size_t i = 0; i < 4; i++)
+		{
+			const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 64 * w + 16 * i));
+
+			s |= std::uint64_t(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(block, vsyn)))) << (16 * i);
+			e |= std::uint64_t(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(block, vexp)))) << (16 * i);
+		}
+
+		syn[w] = s;
+		exp[w] = e;
+	}
+}
+
+__attribute__((target("avx2"))) static void classify_avx2(const std::byte *data, const size_t words, std::uint64_t *syn,
+	std::uint64_t *exp)
+{
+	const __m256i vsyn = _mm256_set1_epi8(char(0xaa));
+	const __m256i vexp = _mm256_set1_epi8(char(0xa9));
+
+	for (size_t w = 0; w < words; w++)
+	{
+		const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 64 * w));
+		const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 64 * w + 32));
+
+		syn[w] = std::uint64_t(unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, vsyn))))
+			| std::uint64_t(unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, vsyn)))) << 32;
+		exp[w] = std::uint64_t(unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, vexp))))
+			| std::uint64_t(unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, vexp)))) << 32;
+	}
+}
+
+#endif
+
+static bool supported(const ebus::EscapeScan::Isa isa)
+{
+#ifdef EBUS_X86
+	__builtin_cpu_init();
+
+	if (isa == ebus::EscapeScan::Isa::avx2) return (__builtin_cpu_supports("avx2"));
+	if (isa == ebus::EscapeScan::Isa::sse2) return (__builtin_cpu_supports("sse2"));
+#endif
+
+	return (isa == ebus::EscapeScan::Isa::scalar);
+}
+
+static ebus::EscapeScan::Isa best()
+{
+	if (supported(ebus::EscapeScan::Isa::avx2)) return (ebus::EscapeScan::Isa::avx2);
+	if (supported(ebus::EscapeScan::Isa::sse2)) return (ebus::EscapeScan::Isa::sse2);
+
+	return (ebus::EscapeScan::Isa::scalar);
+}
+
+static ebus::EscapeScan::Isa current = ebus::EscapeScan::Isa::scalar;
+static classify_t classify_fn = classify_scalar;
+
+// selected before main, so there is no check per call
+[[maybe_unused]] static const bool selected = ebus::EscapeScan::select(best());
+
+// classifies the bytes [pos, pos + 64 * count) of data, a short last word is padded with zero bytes
+static size_t classify(const std::byte *data, const size_t size, const size_t pos, std::uint64_t *syn, std::uint64_t *exp)
+{
+	const size_t words = std::min(chunk_words, (size - pos) / 64);
+
+	if (words > 0)
+	{
+		classify_fn(data + pos, words, syn, exp);
+		return (words);
+	}
+
+	std::byte tail[64] = {};
+	std::memcpy(tail, data + pos, size - pos);
+
+	classify_fn(tail, 1, syn, exp);
+
+	const std::uint64_t valid = ~std::uint64_t(0) >> (64 - (size - pos));
+	syn[0] &= valid;
+	exp[0] &= valid;
+
+	return (1);
+}
+
+// copies a run of up to 64 bytes: with room behind the run and separate buffers whole 64 bytes are
+// copied, which the compiler inlines
+static inline void copy(std::byte *out, const std::byte *in, const size_t len, const bool overcopy)
+{
+	if (overcopy)
+		std::memcpy(out, in, 64);
+	else
+		std::memmove(out, in, len);
+}
+
+ebus::EscapeScan::Isa ebus::EscapeScan::isa()
+{
+	return (current);
+}
+
+bool ebus::EscapeScan::select(const Isa isa)
+{
+	if (!supported(isa)) return (false);
+
+	switch (isa)
+	{
+#ifdef EBUS_X86
+	case Isa::avx2:
+		classify_fn = classify_avx2;
+		break;
+	case Isa::sse2:
+		classify_fn = classify_sse2;
+		break;
+#endif
+	default:
+		classify_fn = classify_scalar;
+		break;
+	}
+
+	current = isa;
+
+	return (true);
+}
+
+const char* ebus::EscapeScan::name(const Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::avx2:
+		return ("avx2");
+	case Isa::sse2:
+		return ("sse2");
+	default:
+		return ("scalar");
+	}
+}
+
+size_t ebus::EscapeScan::split(const std::byte *data, const size_t size, size_t *offsets, size_t *sizes, const size_t max,
+	size_t &next)
+{
+	next = 0;
+	if (max == 0) return (0);
+
+	std::uint64_t syn[chunk_words];
+	std::uint64_t exp[chunk_words];
+
+	size_t count = 0;
+	size_t start = 0;
+	size_t pos = 0;
+
+	while (pos < size)
+	{
+		const size_t words = classify(data, size, pos, syn, exp);
+
+		for (size_t w = 0; w < words; w++, pos += 64)
+		{
+			for (std::uint64_t bits = syn[w]; bits != 0; bits &= bits - 1)
+			{
+				const size_t end = pos + __builtin_ctzll(bits);
+
+				if (end > start)
+				{
+					offsets[count] = start;
+					sizes[count] = end - start;
+
+					if (++count == max)
+					{
+						next = end + 1;
+						return (count);
+					}
+				}
+
+				start = end + 1;
+			}
+		}
+	}
+
+	// the last part ends with the stream
+	if (size > start && count < max)
+	{
+		offsets[count] = start;
+		sizes[count] = size - start;
+		count++;
+	}
+
+	next = size;
+
+	return (count);
+}
+
+size_t ebus::EscapeScan::decode(const std::byte *in, const size_t size, std::byte *out, size_t *offsets, size_t *sizes,
+	const size_t max, size_t &next)
+{
+	next = 0;
+	if (max == 0) return (0);
+
+	std::uint64_t syn[chunk_words];
+	std::uint64_t exp[chunk_words];
+
+	size_t count = 0;
+	size_t out_pos = 0;
+	bool open = false;
+	bool pending = false;
+	size_t pos = 0;
+
+	const std::uintptr_t in_begin = reinterpret_cast<std::uintptr_t>(in);
+	const std::uintptr_t out_begin = reinterpret_cast<std::uintptr_t>(out);
+	const bool separate = out_begin + size <= in_begin || in_begin + size <= out_begin;
+
+	while (pos < size)
+	{
+		const size_t words = classify(in, size, pos, syn, exp);
+
+		for (size_t w = 0; w < words; w++, pos += 64)
+		{
+			const size_t len = std::min(size_t(64), size - pos);
+			std::uint64_t special = syn[w] | exp[w];
+
+			// escape free word: copied as a whole
+			if (special == 0 && !pending)
+			{
+				if (!open)
+				{
+					offsets[count] = out_pos;
+					open = true;
+				}
+
+				copy(out + out_pos, in + pos, len, separate && pos + 64 <= size);
+				out_pos += len;
+				continue;
+			}
+
+			size_t cur = 0;
+
+			while (cur < len)
+			{
+				const size_t stop = special != 0 ? size_t(__builtin_ctzll(special)) : len;
+
+				// byte following an escape byte
+				if (pending && cur < stop)
+				{
+					if (!open)
+					{
+						offsets[count] = out_pos;
+						open = true;
+					}
+
+					out[out_pos++] = (in[pos + cur] == seq_synexp ? seq_syn : seq_exp);
+					pending = false;
+					cur++;
+				}
+
+				if (cur < stop)
+				{
+					if (!open)
+					{
+						offsets[count] = out_pos;
+						open = true;
+					}
+
+					copy(out + out_pos, in + pos + cur, stop - cur, separate && pos + cur + 64 <= size);
+					out_pos += stop - cur;
+				}
+
+				if (stop == len) break;
+
+				special &= special - 1;
+				cur = stop + 1;
+
+				if (in[pos + stop] == seq_syn)
+				{
+					// a dangling escape byte is dropped
+					pending = false;
+
+					if (open && out_pos > offsets[count])
+					{
+						sizes[count] = out_pos - offsets[count];
+
+						if (++count == max)
+						{
+							next = pos + stop + 1;
+							return (count);
+						}
+					}
+
+					open = false;
+				}
+				else if (pending)
+				{
+					// escaped escape byte
+					if (!open)
+					{
+						offsets[count] = out_pos;
+						open = true;
+					}
+
+					out[out_pos++] = seq_exp;
+					pending = false;
+				}
+				else
+				{
+					pending = true;
+				}
+			}
+		}
+	}
+
+	// the last part ends with the stream
+	if (open && out_pos > offsets[count] && count < max)
+	{
+		sizes[count] = out_pos - offsets[count];
+		count++;
+	}
+
+	next = size;
+
+	return (count);
+}
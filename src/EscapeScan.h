@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_ESCAPESCAN_H
+#define EBUS_ESCAPESCAN_H
+
+#include <cstddef>
+
+namespace ebus
+{
+
+// bulk routines for large byte streams (capture files, replay), vectorised with runtime cpu dispatch
+class EscapeScan
+{
+
+public:
+	enum class Isa
+	{
+		scalar, sse2, avx2
+	};
+
+	// instruction set in use (the best one available unless select was called)
+	static Isa isa();
+
+	// switches to the given instruction set, false if the cpu does not support it (not thread safe)
+	static bool select(const Isa isa);
+
+	static const char* name(const Isa isa);
+
+	// splits a stream at SYN bytes: writes offset and size of up to max non-empty parts and
+	// returns their count; next is the position to continue with (the last part ends with the stream)
+	static size_t split(const std::byte *data, const size_t size, size_t *offsets, size_t *sizes, const size_t max,
+		size_t &next);
+
+	// splits a stream at SYN bytes and unescapes the parts like EscapeDecoder, escape free runs are
+	// copied as a whole; the parts are packed into out (may be equal to in) and described by offsets
+	// and sizes in out; a dangling escape byte before SYN is dropped
+	static size_t decode(const std::byte *in, const size_t size, std::byte *out, size_t *offsets, size_t *sizes,
+		const size_t max, size_t &next);
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_ESCAPESCAN_H
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "LogSink.h"
+
+#include <algorithm>
+#include <cstring>
+
+// pause of the consumer when the ring is empty
+static const long idle_sleep = 5;	// in ms
+
+void ebus::LogRecord::append(const void *data, const size_t len)
+{
+	const size_t count = std::min(len, payload_size - size);
+
+	std::memcpy(payload + size, data, count);
+	size += count;
+
+	if (count < len) truncated = true;
+}
+
+void ebus::LogRecord::set_text(const char *text, const size_t len)
+{
+	kind = LogKind::text;
+	append(text, len);
+}
+
+void ebus::LogRecord::set_bytes(const char *text, const std::byte *data, const size_t len)
+{
+	kind = LogKind::bytes;
+	append(text, std::strlen(text));
+	split = size;
+	append(data, len);
+}
+
+void ebus::LogRecord::set_number(const char *text, const long value)
+{
+	kind = LogKind::number;
+	append(text, std::strlen(text));
+	number = value;
+}
+
+void ebus::LogRecord::set_telegram(const char *before, const Telegram &tel, const char *after, const bool slave)
+{
+	const SequenceView master = tel.getMasterView();
+	const SequenceView response = tel.getSlaveView();
+
+	kind = LogKind::telegram;
+	prefix = before;
+	suffix = after;
+	master_state = std::int8_t(tel.getMasterState());
+	slave_state = std::int8_t(tel.getSlaveState());
+	type = tel.get_type();
+	slave_only = slave;
+
+	append(master.data(), master.size());
+	split = size;
+	append(response.data(), response.size());
+}
+
+const std::string ebus::LogRecord::to_string() const
+{
+	const char *text = reinterpret_cast<const char*>(payload);
+	std::string result;
+
+	switch (kind)
+	{
+	case LogKind::text:
+		result.assign(text, size);
+		break;
+	case LogKind::bytes:
+		result.assign(text, split);
+		result += Telegram::hex(SequenceView(payload + split, size - split));
+		break;
+	case LogKind::number:
+		result.assign(text, size);
+		result += std::to_string(number);
+		break;
+	case LogKind::telegram:
+	{
+		const SequenceView master(payload, split);
+		const SequenceView slave(payload + split, size - split);
+
+		result = prefix;
+
+		if (slave_only)
+			result += Telegram::formatSlave(slave, slave_state, type);
+		else
+			result += Telegram::format(master, master_state, slave, slave_state, type);
+
+		result += suffix;
+		break;
+	}
+	default:
+		break;
+	}
+
+	if (truncated) result += "...";
+
+	return (result);
+}
+
+ebus::LogSink::LogSink(std::shared_ptr<ILogger> logger) : m_logger(logger)
+{
+	m_thread = std::thread(&LogSink::run, this);
+}
+
+ebus::LogSink::~LogSink()
+{
+	m_running = false;
+	m_thread.join();
+}
+
+ebus::LogRecord* ebus::LogSink::claim()
+{
+	const size_t head = m_head.load(std::memory_order_relaxed);
+
+	if (head - m_tail.load(std::memory_order_acquire) == capacity)
+	{
+		m_overflows.fetch_add(1, std::memory_order_relaxed);
+		return (nullptr);
+	}
+
+	LogRecord *record = &m_ring[head & (capacity - 1)];
+	*record = LogRecord();
+
+	return (record);
+}
+
+void ebus::LogSink::commit()
+{
+	m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+long ebus::LogSink::overflows() const
+{
+	return (m_overflows.load(std::memory_order_relaxed));
+}
+
+void ebus::LogSink::run()
+{
+	while (m_running)
+		if (!drain()) std::this_thread::sleep_for(std::chrono::milliseconds(idle_sleep));
+
+	// records logged before the sink was removed
+	drain();
+}
+
+bool ebus::LogSink::drain()
+{
+	const size_t head = m_head.load(std::memory_order_acquire);
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+
+	if (head == tail) return (false);
+
+	for (; tail != head; tail++)
+	{
+		const LogRecord &record = m_ring[tail & (capacity - 1)];
+
+		if (m_logger != nullptr) m_logger->log(record.level, record.time, record.to_string());
+
+		m_tail.store(tail + 1, std::memory_order_release);
+	}
+
+	const long overflows = m_overflows.load(std::memory_order_relaxed);
+
+	if (overflows != m_reported && m_logger != nullptr)
+	{
+		m_logger->log(LogLevel::warn, std::chrono::steady_clock::now(),
+			std::to_string(overflows - m_reported) + " log records lost");
+
+		m_reported = overflows;
+	}
+
+	return (true);
+}
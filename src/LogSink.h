@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_LOGSINK_H
+#define EBUS_LOGSINK_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../include/ebus/Ebus.h"
+#include "Telegram.h"
+
+namespace ebus
+{
+
+enum class LogKind : std::uint8_t
+{
+	text,		// payload is the text
+	bytes,		// payload is a text followed by bytes printed as hex
+	number,		// payload is a text followed by number
+	telegram	// payload are master and slave bytes of a telegram between prefix and suffix
+};
+
+// fixed size binary log record, filled without allocation and formatted later
+struct LogRecord
+{
+	static const size_t payload_size = 96;
+
+	std::chrono::steady_clock::time_point time;
+	LogLevel level = LogLevel::off;
+	LogKind kind = LogKind::text;
+
+	// used payload bytes and end of the first part (text or master bytes)
+	std::uint8_t size = 0;
+	std::uint8_t split = 0;
+	bool truncated = false;
+
+	long number = 0;
+
+	// telegram: static texts around it, states and type, slave part only
+	const char *prefix = "";
+	const char *suffix = "";
+	std::int8_t master_state = 0;
+	std::int8_t slave_state = 0;
+	Type type = Type::undefined;
+	bool slave_only = false;
+
+	std::byte payload[payload_size];
+
+	void set_text(const char *text, const size_t len);
+	void set_bytes(const char *text, const std::byte *data, const size_t len);
+	void set_number(const char *text, const long value);
+	void set_telegram(const char *before, const Telegram &tel, const char *after, const bool slave);
+
+	const std::string to_string() const;
+
+private:
+	void append(const void *data, const size_t len);
+};
+
+// asynchronous log sink: the bus thread writes records into a single producer single consumer ring
+// without lock or allocation, a background thread formats them and forwards them to the logger
+class LogSink
+{
+
+public:
+	explicit LogSink(std::shared_ptr<ILogger> logger);
+	~LogSink();
+
+	LogSink(const LogSink&) = delete;
+	LogSink& operator=(const LogSink&) = delete;
+
+	// free record or nullptr if the ring is full (the record is counted as lost)
+	LogRecord* claim();
+
+	// publishes the claimed record
+	void commit();
+
+	long overflows() const;
+
+private:
+	// power of two
+	static const size_t capacity = 512;
+
+	std::shared_ptr<ILogger> m_logger;
+
+	std::array<LogRecord, capacity> m_ring;
+
+	alignas(64) std::atomic<size_t> m_head = 0;	// written by the producer
+	alignas(64) std::atomic<size_t> m_tail = 0;	// written by the consumer
+
+	std::atomic<long> m_overflows = 0;
+	long m_reported = 0;
+
+	std::atomic<bool> m_running = true;
+	std::thread m_thread;
+
+	void run();
+	bool drain();
+};
+
+} // namespace ebus
+
+#endif // EBUS_LOGSINK_H
@@ -37,12 +37,8 @@ public:
 	void wait()
 	{
 		std::unique_lock<std::mutex> lock(m_mutex);
-		while (!m_notify)
-		{
-			m_condition.wait(lock);
-			m_notify = false;
-			break;
-		}
+		m_condition.wait(lock, [this]() { return (m_notify); });
+		m_notify = false;
 	}
 
 	void notify()
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "ReplayTransport.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include "end_of_input.h"
+#include "runtime_warning.h"
+
+// 2400 baud, 1 start bit + 8 data bits + 1 stop bit
+static const long byte_time = 10L * 1000000000L / 2400L; // ns
+
+static long long nanoseconds(const struct timespec &time)
+{
+	return (time.tv_sec * 1000000000LL + time.tv_nsec);
+}
+
+ebus::ReplayTransport::ReplayTransport(const std::string &file, const bool paced) : m_file(file), m_paced(paced)
+{
+}
+
+ebus::ReplayTransport::~ReplayTransport()
+{
+	close();
+}
+
+void ebus::ReplayTransport::open()
+{
+	int fd = ::open(m_file.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) throw std::runtime_error("An error occurred while opening the replay file");
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error("An error occurred while opening the replay file");
+	}
+
+	m_size = static_cast<size_t>(st.st_size);
+	m_pos = 0;
+
+	if (m_size > 0)
+	{
+		void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (data == MAP_FAILED)
+		{
+			::close(fd);
+			throw std::runtime_error("An error occurred while mapping the replay file");
+		}
+
+		madvise(data, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const std::byte*>(data);
+	}
+
+	// the mapping stays valid without descriptor
+	::close(fd);
+
+	clock_gettime(CLOCK_MONOTONIC, &m_start);
+}
+
+void ebus::ReplayTransport::close()
+{
+	if (m_data != nullptr) munmap(const_cast<std::byte*>(m_data), m_size);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_pos = 0;
+}
+
+int ebus::ReplayTransport::fd() const
+{
+	return (-1);
+}
+
+bool ebus::ReplayTransport::explicitOpen() const
+{
+	// a replay must not run before the callbacks are registered
+	return (true);
+}
+
+int ebus::ReplayTransport::poll(const short events, const struct timespec *timeout, short &revents)
+{
+	revents = 0;
+
+	// writing is refused by write(), end of data is reported by read()
+	if ((events & POLLIN) == 0 || m_pos >= m_size || due() > m_pos)
+	{
+		revents = events;
+		return (1);
+	}
+
+	// paced: sleep until the next byte has passed the wire
+	struct timespec next = dueTime(m_pos + 1);
+
+	if (timeout != nullptr)
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		if (nanoseconds(next) - nanoseconds(now) > nanoseconds(*timeout))
+		{
+			nanosleep(timeout, nullptr);
+			return (0);
+		}
+	}
+
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+
+	revents = POLLIN;
+	return (1);
+}
+
+ssize_t ebus::ReplayTransport::read(std::byte *data, const size_t size)
+{
+	if (m_pos >= m_size) throw ebus::end_of_input("The end of the replay file has been reached");
+
+	size_t count = std::min(size, (m_paced ? due() : m_size) - m_pos);
+
+	if (count == 0)
+	{
+		errno = EAGAIN;
+		return (-1);
+	}
+
+	std::copy(m_data + m_pos, m_data + m_pos + count, data);
+	m_pos += count;
+
+	return (count);
+}
+
+ssize_t ebus::ReplayTransport::write(const std::byte *data, const size_t size)
+{
+	(void) data;
+	(void) size;
+
+	throw ebus::runtime_warning("The replay device is read-only");
+}
+
+size_t ebus::ReplayTransport::due() const
+{
+	if (!m_paced) return (m_size);
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (std::min(m_size, static_cast<size_t>((nanoseconds(now) - nanoseconds(m_start)) / byte_time)));
+}
+
+struct timespec ebus::ReplayTransport::dueTime(const size_t count) const
+{
+	long long time = nanoseconds(m_start) + static_cast<long long>(count) * byte_time;
+
+	struct timespec result =
+	{ static_cast<time_t>(time / 1000000000LL), static_cast<long>(time % 1000000000LL) };
+
+	return (result);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_REPLAYTRANSPORT_H
+#define EBUS_REPLAYTRANSPORT_H
+
+#include <ctime>
+#include <string>
+
+#include "Transport.h"
+
+namespace ebus
+{
+
+// raw capture file (bytes as delivered by 'rawdata') presented as ebus device
+class ReplayTransport : public Transport
+{
+
+public:
+	ReplayTransport(const std::string &file, const bool paced);
+	~ReplayTransport();
+
+	void open() override;
+	void close() override;
+
+	int fd() const override;
+
+	bool explicitOpen() const override;
+
+	int poll(const short events, const struct timespec *timeout, short &revents) override;
+
+	ssize_t read(std::byte *data, const size_t size) override;
+	ssize_t write(const std::byte *data, const size_t size) override;
+
+private:
+	const std::string m_file;
+	const bool m_paced;
+
+	const std::byte *m_data = nullptr;
+	size_t m_size = 0;
+	size_t m_pos = 0;
+
+	struct timespec m_start = {};
+
+	size_t due() const;
+
+	struct timespec dueTime(const size_t count) const;
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_REPLAYTRANSPORT_H
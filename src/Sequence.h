@@ -20,56 +20,73 @@
 #ifndef EBUS_SEQUENCE_H
 #define EBUS_SEQUENCE_H
 
+#include <array>
+#include <chrono>
 #include <cstddef>
 #include <string>
 #include <vector>
 
+#include "../include/ebus/Ebus.h"
+#include "Escape.h"
+
 namespace ebus
 {
 
-static const std::byte seq_zero = std::byte(0x00);     // zero byte
-
-static const std::byte seq_syn = std::byte(0xaa);      // synchronization byte
-static const std::byte seq_exp = std::byte(0xa9);      // expand byte
-static const std::byte seq_synexp = std::byte(0x01);   // expanded synchronization byte
-static const std::byte seq_expexp = std::byte(0x00);   // expanded expand byte
-
 class Sequence
 {
 
 public:
 	static const size_t npos = -1;
 
+	// inline storage: a complete extended telegram incl. acknowledges fits several times
+	static const size_t capacity = 256;
+
 	Sequence() = default;
 	Sequence(const Sequence &seq, const size_t index, size_t len = 0);
 
 	void assign(const std::vector<std::byte> &vec, const bool extended = true);
+	void assign(const std::byte *data, const size_t size, const bool extended = true);
 
 	void push_back(const std::byte byte, const bool extended = true);
+	void push_back(const std::byte byte, const std::chrono::steady_clock::time_point &time, const bool extended = true);
 
 	const std::byte& operator[](const size_t index) const;
-	const std::vector<std::byte> range(const size_t index, const size_t len);
+	const std::byte* data() const;
+	const std::vector<std::byte> range(const size_t index, const size_t len) const;
 
 	size_t size() const;
+	size_t reduced_size() const;
 
 	void clear();
 
-	std::byte crc();
+	std::byte crc() const;
 
 	void extend();
 	void reduce();
 
 	const std::string to_string() const;
 	const std::vector<std::byte> get_sequence() const;
+	SequenceView view() const;
+
+	const std::chrono::steady_clock::time_point& begin_time() const;
+	const std::chrono::steady_clock::time_point& end_time() const;
 
 	static const std::vector<std::byte> range(const std::vector<std::byte> &seq, const size_t index, const size_t len);
 
 private:
-	std::vector<std::byte> m_seq;
+	std::array<std::byte, capacity> m_seq = {};
+	size_t m_size = 0;
 
 	bool m_extended = false;
 
-	std::byte calc_crc(const std::byte byte, const std::byte init);
+	// running crc of the extended bytes (unchanged by extend and reduce)
+	std::byte m_crc = seq_zero;
+
+	// receive time of first and last byte
+	std::chrono::steady_clock::time_point m_begin;
+	std::chrono::steady_clock::time_point m_end;
+
+	void update_crc(const std::byte byte, const bool extended);
 };
 
 } // namespace ebus
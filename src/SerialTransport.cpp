@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "SerialTransport.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static int readLatencyTimer(const std::string &path)
+{
+	int value = -1;
+
+	std::ifstream ifs(path);
+	if (!(ifs >> value)) value = -1;
+
+	return (value);
+}
+
+static void writeLatencyTimer(const std::string &path, const int value)
+{
+	std::ofstream ofs(path);
+	ofs << value << std::endl;
+}
+
+ebus::SerialTransport::SerialTransport(const std::string &device, const speed_t speed) : m_device(device), m_speed(speed)
+{
+}
+
+void ebus::SerialTransport::open()
+{
+	struct termios newSettings;
+
+	// open file descriptor
+	m_fd = ::open(m_device.c_str(), O_RDWR | O_NOCTTY);
+	if (m_fd < 0 || isatty(m_fd) == 0)
+	{
+		if (m_fd >= 0) ::close(m_fd);
+		m_fd = -1;
+
+		throw std::runtime_error("An error occurred while opening the ebus device");
+	}
+
+	// save current settings
+	tcgetattr(m_fd, &m_oldSettings);
+
+	// create new settings
+	std::memset(&newSettings, '\0', sizeof(newSettings));
+
+	newSettings.c_cflag |= (m_speed | CS8 | CLOCAL | CREAD);
+	newSettings.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG); // non-canonical mode
+	newSettings.c_iflag |= IGNPAR; // ignore parity errors
+	newSettings.c_oflag &= ~OPOST;
+
+	// non-canonical mode: read() blocks until at least one byte is available
+	newSettings.c_cc[VMIN] = 1;
+	newSettings.c_cc[VTIME] = 0;
+
+	// empty device buffer
+	tcflush(m_fd, TCIFLUSH);
+
+	// activate new settings of serial device
+	tcsetattr(m_fd, TCSAFLUSH, &newSettings);
+
+	// set serial device into blocking mode
+	fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_NONBLOCK);
+}
+
+void ebus::SerialTransport::close()
+{
+	if (m_fd < 0) return;
+
+	restore();
+
+	// empty device buffer
+	tcflush(m_fd, TCIOFLUSH);
+
+	// activate old settings of serial device
+	tcsetattr(m_fd, TCSANOW, &m_oldSettings);
+
+	// close file descriptor from serial device
+	::close(m_fd);
+
+	m_fd = -1;
+}
+
+int ebus::SerialTransport::fd() const
+{
+	return (m_fd);
+}
+
+void ebus::SerialTransport::lowLatency(const bool enable, LowLatency &state)
+{
+	state = LowLatency();
+	state.enabled = enable;
+
+	if (m_fd < 0) return;
+
+	// driver side low latency flag (not supported by pseudo terminals)
+	struct serial_struct serial;
+	std::memset(&serial, 0, sizeof(serial));
+
+	if (ioctl(m_fd, TIOCGSERIAL, &serial) == 0)
+	{
+		if (!m_savedFlags)
+		{
+			m_oldFlags = serial.flags;
+			m_savedFlags = true;
+		}
+
+		if (enable)
+			serial.flags |= ASYNC_LOW_LATENCY;
+		else
+			serial.flags = (serial.flags & ~ASYNC_LOW_LATENCY) | (m_oldFlags & ASYNC_LOW_LATENCY);
+
+		ioctl(m_fd, TIOCSSERIAL, &serial);
+
+		if (ioctl(m_fd, TIOCGSERIAL, &serial) == 0) state.async_low_latency = ((serial.flags & ASYNC_LOW_LATENCY) != 0);
+	}
+
+	// latency timer of usb serial converters (e.g. ftdi default: 16 ms)
+	const std::string path = latencyTimerPath();
+	int timer = readLatencyTimer(path);
+
+	if (timer >= 0)
+	{
+		if (m_oldLatencyTimer < 0) m_oldLatencyTimer = timer;
+
+		writeLatencyTimer(path, enable ? 1 : m_oldLatencyTimer);
+
+		state.latency_timer = readLatencyTimer(path);
+	}
+}
+
+bool ebus::SerialTransport::check(DeviceCounters &counters)
+{
+	int port;
+
+	// a pseudo terminal has no modem lines, only a vanished device counts as disconnect
+	if (ioctl(m_fd, TIOCMGET, &port) == -1 && errno != ENOTTY && errno != EINVAL) return (false);
+
+	struct serial_icounter_struct icount;
+	std::memset(&icount, 0, sizeof(icount));
+
+	counters.supported = (ioctl(m_fd, TIOCGICOUNT, &icount) == 0);
+
+	if (counters.supported)
+	{
+		counters.rx = icount.rx;
+		counters.tx = icount.tx;
+		counters.frame = icount.frame;
+		counters.overrun = icount.overrun;
+		counters.parity = icount.parity;
+		counters.brk = icount.brk;
+		counters.buf_overrun = icount.buf_overrun;
+	}
+
+	return (true);
+}
+
+const std::string ebus::SerialTransport::latencyTimerPath() const
+{
+	char path[PATH_MAX];
+
+	if (realpath(m_device.c_str(), path) == nullptr) return ("");
+
+	std::string name(path);
+	name = name.substr(name.rfind('/') + 1);
+
+	return ("/sys/class/tty/" + name + "/device/latency_timer");
+}
+
+void ebus::SerialTransport::restore()
+{
+	if (m_savedFlags)
+	{
+		struct serial_struct serial;
+		std::memset(&serial, 0, sizeof(serial));
+
+		if (ioctl(m_fd, TIOCGSERIAL, &serial) == 0)
+		{
+			serial.flags = (serial.flags & ~ASYNC_LOW_LATENCY) | (m_oldFlags & ASYNC_LOW_LATENCY);
+			ioctl(m_fd, TIOCSSERIAL, &serial);
+		}
+
+		m_savedFlags = false;
+	}
+
+	if (m_oldLatencyTimer >= 0)
+	{
+		writeLatencyTimer(latencyTimerPath(), m_oldLatencyTimer);
+		m_oldLatencyTimer = -1;
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_SERIALTRANSPORT_H
+#define EBUS_SERIALTRANSPORT_H
+
+#include <termios.h>
+#include <string>
+
+#include "Transport.h"
+
+namespace ebus
+{
+
+class SerialTransport : public Transport
+{
+
+public:
+	explicit SerialTransport(const std::string &device, const speed_t speed = B2400);
+
+	void open() override;
+	void close() override;
+
+	int fd() const override;
+
+	bool check(DeviceCounters &counters) override;
+
+	void lowLatency(const bool enable, LowLatency &state) override;
+
+private:
+	const std::string m_device;
+	const speed_t m_speed;
+
+	termios m_oldSettings = {};
+
+	int m_fd = -1;
+
+	// driver settings before low latency mode
+	bool m_savedFlags = false;
+	int m_oldFlags = 0;
+	int m_oldLatencyTimer = -1;
+
+	const std::string latencyTimerPath() const;
+
+	void restore();
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_SERIALTRANSPORT_H
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "TcpTransport.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+static const int connect_timeout = 5000; // ms
+
+ebus::TcpTransport::TcpTransport(const std::string &address)
+{
+	// host:port or [ipv6]:port
+	size_t pos = address.rfind(':');
+
+	if (pos != std::string::npos)
+	{
+		m_host = address.substr(0, pos);
+		m_port = address.substr(pos + 1);
+	}
+
+	if (m_host.size() > 1 && m_host.front() == '[' && m_host.back() == ']') m_host = m_host.substr(1, m_host.size() - 2);
+}
+
+void ebus::TcpTransport::open()
+{
+	struct addrinfo hints = {};
+	struct addrinfo *result = nullptr;
+
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	if (m_host.empty() || m_port.empty() || getaddrinfo(m_host.c_str(), m_port.c_str(), &hints, &result) != 0)
+		throw std::runtime_error("An error occurred while resolving the ebus device address");
+
+	for (const struct addrinfo *info = result; info != nullptr && m_fd < 0; info = info->ai_next)
+		connect(info);
+
+	freeaddrinfo(result);
+
+	if (m_fd < 0) throw std::runtime_error("An error occurred while opening the ebus device");
+
+	// send every byte immediately, ebus timing does not allow nagle delays
+	int flag = 1;
+	setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+	setsockopt(m_fd, SOL_SOCKET, SO_KEEPALIVE, &flag, sizeof(flag));
+
+	// receive time stamps of the kernel
+	setsockopt(m_fd, SOL_SOCKET, SO_TIMESTAMPNS, &flag, sizeof(flag));
+}
+
+void ebus::TcpTransport::close()
+{
+	if (m_fd < 0) return;
+
+	::close(m_fd);
+
+	m_fd = -1;
+}
+
+int ebus::TcpTransport::fd() const
+{
+	return (m_fd);
+}
+
+ssize_t ebus::TcpTransport::read(std::byte *data, const size_t size)
+{
+	struct iovec iov =
+	{ data, size };
+
+	char control[CMSG_SPACE(sizeof(struct timespec))];
+
+	struct msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	ssize_t nbytes = ::recvmsg(m_fd, &msg, MSG_DONTWAIT);
+
+	m_hasTime = false;
+
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); nbytes > 0 && cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+		{
+			struct timespec stamp, real, mono;
+			std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+
+			clock_gettime(CLOCK_REALTIME, &real);
+			clock_gettime(CLOCK_MONOTONIC, &mono);
+
+			// kernel stamps are wall clock times, move them onto the monotonic clock
+			std::chrono::nanoseconds age = std::chrono::seconds(real.tv_sec - stamp.tv_sec)
+				+ std::chrono::nanoseconds(real.tv_nsec - stamp.tv_nsec);
+
+			m_time = std::chrono::steady_clock::time_point(
+				std::chrono::seconds(mono.tv_sec) + std::chrono::nanoseconds(mono.tv_nsec)) - age;
+			m_hasTime = true;
+		}
+	}
+
+	// an orderly shutdown of the peer is a lost connection, not an end of data
+	if (nbytes == 0)
+	{
+		errno = ECONNRESET;
+		return (-1);
+	}
+
+	return (nbytes);
+}
+
+ssize_t ebus::TcpTransport::write(const std::byte *data, const size_t size)
+{
+	// a closed peer is reported as EPIPE instead of raising SIGPIPE
+	return (::send(m_fd, data, size, MSG_NOSIGNAL));
+}
+
+bool ebus::TcpTransport::timestamp(std::chrono::steady_clock::time_point &time)
+{
+	if (m_hasTime) time = m_time;
+
+	return (m_hasTime);
+}
+
+void ebus::TcpTransport::connect(const struct addrinfo *info)
+{
+	int fd = socket(info->ai_family, info->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, info->ai_protocol);
+	if (fd < 0) return;
+
+	if (::connect(fd, info->ai_addr, info->ai_addrlen) != 0)
+	{
+		if (errno != EINPROGRESS)
+		{
+			::close(fd);
+			return;
+		}
+
+		struct pollfd fds = {};
+
+		fds.fd = fd;
+		fds.events = POLLOUT;
+
+		int error = ETIMEDOUT;
+		socklen_t len = sizeof(error);
+
+		if (::poll(&fds, 1, connect_timeout) == 1) getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+
+		if (error != 0)
+		{
+			::close(fd);
+			return;
+		}
+	}
+
+	m_fd = fd;
+}
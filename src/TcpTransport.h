@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_TCPTRANSPORT_H
+#define EBUS_TCPTRANSPORT_H
+
+#include <netdb.h>
+#include <chrono>
+#include <string>
+
+#include "Transport.h"
+
+namespace ebus
+{
+
+class TcpTransport : public Transport
+{
+
+public:
+	explicit TcpTransport(const std::string &address);
+
+	void open() override;
+	void close() override;
+
+	int fd() const override;
+
+	ssize_t read(std::byte *data, const size_t size) override;
+	ssize_t write(const std::byte *data, const size_t size) override;
+
+	bool timestamp(std::chrono::steady_clock::time_point &time) override;
+
+private:
+	std::string m_host;
+	std::string m_port;
+
+	int m_fd = -1;
+
+	// kernel receive time of the last read
+	std::chrono::steady_clock::time_point m_time;
+	bool m_hasTime = false;
+
+	void connect(const struct addrinfo *info);
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_TCPTRANSPORT_H
@@ -19,10 +19,13 @@
 
 #include "Telegram.h"
 
-#include <iomanip>
 #include <map>
 #include <sstream>
 
+#include "Crc.h"
+#include "../include/ebus/Hex.h"
+#include "../include/ebus/Protocol.h"
+
 std::map<int, std::string> SequenceErrors =
 {
 
@@ -43,31 +46,84 @@ ebus::Telegram::Telegram(Sequence &seq)
 	parse(seq);
 }
 
+ebus::Telegram::Telegram(const Telegram &other)
+{
+	*this = other;
+}
+
+ebus::Telegram& ebus::Telegram::operator=(const Telegram &other)
+{
+	if (this == &other) return (*this);
+
+	other.materialize();
+
+	m_type = other.m_type;
+
+	m_source = nullptr;
+	m_masterOffset = other.m_masterOffset;
+	m_masterSize = other.m_masterSize;
+	m_slaveOffset = other.m_slaveOffset;
+	m_slaveSize = other.m_slaveSize;
+
+	m_master = other.m_master;
+	m_masterNN = other.m_masterNN;
+	m_masterCRC = other.m_masterCRC;
+	m_masterCRCValid = other.m_masterCRCValid;
+	m_masterState = other.m_masterState;
+
+	m_slaveACK = other.m_slaveACK;
+
+	m_slave = other.m_slave;
+	m_slaveNN = other.m_slaveNN;
+	m_slaveCRC = other.m_slaveCRC;
+	m_slaveCRCValid = other.m_slaveCRCValid;
+	m_slaveState = other.m_slaveState;
+
+	m_masterACK = other.m_masterACK;
+
+	m_begin = other.m_begin;
+	m_end = other.m_end;
+
+	return (*this);
+}
+
 void ebus::Telegram::parse(Sequence &seq)
 {
-	clear();
 	seq.reduce();
-	int offset = 0;
 
-	m_masterState = checkMasterSequence(seq);
+	parse(seq.data(), seq.size());
+	setTime(seq.begin_time(), seq.end_time());
+
+	materialize();
+}
+
+void ebus::Telegram::parse(const std::byte *data, const size_t size)
+{
+	clear();
+	m_source = data;
+
+	m_masterState = checkMasterSequence(data, size);
 
 	if (m_masterState != SEQ_OK) return;
 
-	Sequence master(seq, 0, 5 + std::to_integer<int>(seq[4]) + 1);
-	createMaster(master);
+	setMaster(0);
 
 	if (m_masterState != SEQ_OK) return;
 
+	size_t offset = 0;
+
 	if (m_type != Type::BC)
 	{
+		size_t ack = 5 + m_masterNN + 1;
+
 		// acknowledge byte is missing
-		if (seq.size() <= (size_t) (5 + m_masterNN + 1))
+		if (size <= ack)
 		{
 			m_slaveState = SEQ_ERR_ACK_MISS;
 			return;
 		}
 
-		m_slaveACK = seq[5 + m_masterNN + 1];
+		m_slaveACK = data[ack];
 
 		// acknowledge byte is invalid
 		if (m_slaveACK != seq_ack && m_slaveACK != seq_nak)
@@ -79,34 +135,27 @@ void ebus::Telegram::parse(Sequence &seq)
 		// handle NAK from slave
 		if (m_slaveACK == seq_nak)
 		{
-			// sequence is too short
-			if (seq.size() < (size_t) (master.size() + 1))
-			{
-				m_masterState = SEQ_ERR_SHORT;
-				return;
-			}
-
-			offset = master.size() + 1;
-			m_master.clear();
+			offset = ack + 1;
+			m_masterSize = 0;
 
-			Sequence tmp(seq, offset);
-			m_masterState = checkMasterSequence(tmp);
+			m_masterState = checkMasterSequence(data + offset, size - offset);
 
 			if (m_masterState != SEQ_OK) return;
 
-			Sequence master2(tmp, 0, 5 + std::to_integer<int>(tmp[4]) + 1);
-			createMaster(master2);
+			setMaster(offset);
 
 			if (m_masterState != SEQ_OK) return;
 
+			ack = offset + 5 + m_masterNN + 1;
+
 			// acknowledge byte is missing
-			if (tmp.size() <= (size_t) (5 + m_masterNN + 1))
+			if (size <= ack)
 			{
 				m_slaveState = SEQ_ERR_ACK_MISS;
 				return;
 			}
 
-			m_slaveACK = tmp[5 + m_masterNN + 1];
+			m_slaveACK = data[ack];
 
 			// acknowledge byte is invalid
 			if (m_slaveACK != seq_ack && m_slaveACK != seq_nak)
@@ -119,7 +168,7 @@ void ebus::Telegram::parse(Sequence &seq)
 			if (m_slaveACK == seq_nak)
 			{
 				// sequence is too long
-				if (tmp.size() > (size_t) (5 + m_masterNN + 2))
+				if (size > ack + 1)
 					m_masterState = SEQ_ERR_LONG;
 
 				// sequence is invalid
@@ -135,24 +184,24 @@ void ebus::Telegram::parse(Sequence &seq)
 	{
 		offset += 5 + m_masterNN + 2;
 
-		Sequence seq2(seq, offset);
-		m_slaveState = checkSlaveSequence(seq2);
+		m_slaveState = checkSlaveSequence(data + offset, size - offset);
 
 		if (m_slaveState != SEQ_OK) return;
 
-		Sequence slave(seq2, 0, 1 + std::to_integer<int>(seq2[0]) + 1);
-		createSlave(slave);
+		setSlave(offset);
 
 		if (m_slaveState != SEQ_OK) return;
 
+		size_t ack = offset + 1 + m_slaveNN + 1;
+
 		// acknowledge byte is missing
-		if (seq2.size() <= (size_t) (1 + m_slaveNN + 1))
+		if (size <= ack)
 		{
 			m_masterState = SEQ_ERR_ACK_MISS;
 			return;
 		}
 
-		m_masterACK = seq2[1 + m_slaveNN + 1];
+		m_masterACK = data[ack];
 
 		// acknowledge byte is invalid
 		if (m_masterACK != seq_ack && m_masterACK != seq_nak)
@@ -165,31 +214,31 @@ void ebus::Telegram::parse(Sequence &seq)
 		if (m_masterACK == seq_nak)
 		{
 			// sequence is too short
-			if (seq2.size() < (size_t) (slave.size() + 2))
+			if (size < ack + 2)
 			{
 				m_slaveState = SEQ_ERR_SHORT;
 				return;
 			}
 
-			offset = slave.size() + 2;
-			m_slave.clear();
+			offset = ack + 2;
+			m_slaveSize = 0;
 
-			Sequence tmp(seq2, offset);
-			m_slaveState = checkSlaveSequence(tmp);
+			m_slaveState = checkSlaveSequence(data + offset, size - offset);
 
 			if (m_slaveState != SEQ_OK) return;
 
-			Sequence slave2(seq2, offset, 1 + std::to_integer<int>(seq2[offset]) + 1);
-			createSlave(slave2);
+			setSlave(offset);
+
+			ack = offset + 1 + m_slaveNN + 1;
 
 			// acknowledge byte is missing
-			if (tmp.size() <= (size_t) (1 + m_slaveNN + 1))
+			if (size <= ack)
 			{
 				m_masterState = SEQ_ERR_ACK_MISS;
 				return;
 			}
 
-			m_masterACK = tmp[1 + m_slaveNN + 1];
+			m_masterACK = data[ack];
 
 			// acknowledge byte is invalid
 			if (m_masterACK != seq_ack && m_masterACK != seq_nak)
@@ -199,10 +248,10 @@ void ebus::Telegram::parse(Sequence &seq)
 			}
 
 			// sequence is too long
-			if (tmp.size() > (size_t) (1 + m_slaveNN + 2))
+			if (size > ack + 1)
 			{
 				m_slaveState = SEQ_ERR_LONG;
-				m_slave.clear();
+				m_slaveSize = 0;
 				return;
 			}
 
@@ -218,8 +267,25 @@ void ebus::Telegram::parse(Sequence &seq)
 	}
 }
 
+void ebus::Telegram::materialize() const
+{
+	if (m_source == nullptr) return;
+
+	m_master.assign(m_source + m_masterOffset, m_masterSize, false);
+	m_slave.assign(m_source + m_slaveOffset, m_slaveSize, false);
+
+	m_source = nullptr;
+}
+
 void ebus::Telegram::createMaster(const std::byte src, const std::vector<std::byte> &vec)
 {
+	// sequence is too long
+	if (vec.size() >= Sequence::capacity)
+	{
+		m_masterState = SEQ_ERR_LONG;
+		return;
+	}
+
 	Sequence seq;
 
 	seq.push_back(src, false);
@@ -232,7 +298,10 @@ void ebus::Telegram::createMaster(const std::byte src, const std::vector<std::by
 
 void ebus::Telegram::createMaster(Sequence &seq)
 {
+	materialize();
+
 	m_masterState = SEQ_OK;
+	m_masterCRCValid = false;
 	seq.reduce();
 
 	// sequence is too short
@@ -284,6 +353,7 @@ void ebus::Telegram::createMaster(Sequence &seq)
 	{
 		m_master = seq;
 		m_masterCRC = seq.crc();
+		m_masterCRCValid = true;
 	}
 	else
 	{
@@ -291,12 +361,20 @@ void ebus::Telegram::createMaster(Sequence &seq)
 		m_masterCRC = seq[5 + m_masterNN];
 
 		// sequence has a CRC error
-		if (m_master.crc() != m_masterCRC) m_masterState = SEQ_ERR_CRC;
+		m_masterCRCValid = m_master.crc() == m_masterCRC;
+		if (!m_masterCRCValid) m_masterState = SEQ_ERR_CRC;
 	}
 }
 
 void ebus::Telegram::createSlave(const std::vector<std::byte> &vec)
 {
+	// sequence is too long
+	if (vec.size() > Sequence::capacity)
+	{
+		m_slaveState = SEQ_ERR_LONG;
+		return;
+	}
+
 	Sequence seq;
 
 	for (size_t i = 0; i < vec.size(); i++)
@@ -307,7 +385,10 @@ void ebus::Telegram::createSlave(const std::vector<std::byte> &vec)
 
 void ebus::Telegram::createSlave(Sequence &seq)
 {
+	materialize();
+
 	m_slaveState = SEQ_OK;
+	m_slaveCRCValid = false;
 	seq.reduce();
 
 	// sequence is too short
@@ -344,6 +425,7 @@ void ebus::Telegram::createSlave(Sequence &seq)
 	{
 		m_slave = seq;
 		m_slaveCRC = seq.crc();
+		m_slaveCRCValid = true;
 	}
 	else
 	{
@@ -351,7 +433,8 @@ void ebus::Telegram::createSlave(Sequence &seq)
 		m_slaveCRC = seq[1 + m_slaveNN];
 
 		// sequence has a CRC error
-		if (m_slave.crc() != m_slaveCRC) m_slaveState = SEQ_ERR_CRC;
+		m_slaveCRCValid = m_slave.crc() == m_slaveCRC;
+		if (!m_slaveCRCValid) m_slaveState = SEQ_ERR_CRC;
 	}
 }
 
@@ -359,34 +442,59 @@ void ebus::Telegram::clear()
 {
 	m_type = Type::undefined;
 
+	m_source = nullptr;
+	m_masterOffset = 0;
+	m_masterSize = 0;
+	m_slaveOffset = 0;
+	m_slaveSize = 0;
+
 	m_master.clear();
 	m_masterNN = 0;
 	m_masterCRC = seq_zero;
+	m_masterCRCValid = false;
 	m_masterACK = seq_zero;
 	m_masterState = SEQ_EMPTY;
 
 	m_slave.clear();
 	m_slaveNN = 0;
 	m_slaveCRC = seq_zero;
+	m_slaveCRCValid = false;
 	m_slaveACK = seq_zero;
 	m_slaveState = SEQ_EMPTY;
+
+	m_begin = std::chrono::steady_clock::time_point();
+	m_end = std::chrono::steady_clock::time_point();
 }
 
 std::byte ebus::Telegram::getMasterQQ() const
 {
-	return (m_master[0]);
+	return (getMaster()[0]);
 }
 
-ebus::Sequence ebus::Telegram::getMaster() const
+const ebus::Sequence& ebus::Telegram::getMaster() const
 {
+	materialize();
+
 	return (m_master);
 }
 
+ebus::SequenceView ebus::Telegram::getMasterView() const
+{
+	if (m_source != nullptr) return (SequenceView(m_source + m_masterOffset, m_masterSize));
+
+	return (m_master.view());
+}
+
 std::byte ebus::Telegram::getMasterCRC() const
 {
 	return (m_masterCRC);
 }
 
+bool ebus::Telegram::isMasterCRCValid() const
+{
+	return (m_masterCRCValid);
+}
+
 int ebus::Telegram::getMasterState() const
 {
 	return (m_masterState);
@@ -397,16 +505,30 @@ void ebus::Telegram::setSlaveACK(const std::byte byte)
 	m_slaveACK = byte;
 }
 
-ebus::Sequence ebus::Telegram::getSlave() const
+const ebus::Sequence& ebus::Telegram::getSlave() const
 {
+	materialize();
+
 	return (m_slave);
 }
 
+ebus::SequenceView ebus::Telegram::getSlaveView() const
+{
+	if (m_source != nullptr) return (SequenceView(m_source + m_slaveOffset, m_slaveSize));
+
+	return (m_slave.view());
+}
+
 std::byte ebus::Telegram::getSlaveCRC() const
 {
 	return (m_slaveCRC);
 }
 
+bool ebus::Telegram::isSlaveCRCValid() const
+{
+	return (m_slaveCRCValid);
+}
+
 int ebus::Telegram::getSlaveState() const
 {
 	return (m_slaveState);
@@ -422,6 +544,22 @@ ebus::Type ebus::Telegram::get_type() const
 	return (m_type);
 }
 
+void ebus::Telegram::setTime(const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)
+{
+	m_begin = begin;
+	m_end = end;
+}
+
+const std::chrono::steady_clock::time_point& ebus::Telegram::getBeginTime() const
+{
+	return (m_begin);
+}
+
+const std::chrono::steady_clock::time_point& ebus::Telegram::getEndTime() const
+{
+	return (m_end);
+}
+
 bool ebus::Telegram::isValid() const
 {
 	if (m_type != Type::MS) return (m_masterState == SEQ_OK ? true : false);
@@ -429,38 +567,64 @@ bool ebus::Telegram::isValid() const
 	return ((m_masterState + m_slaveState) == SEQ_OK ? true : false);
 }
 
-const std::string ebus::Telegram::to_string()
+const std::string ebus::Telegram::to_string() const
+{
+	return (format(getMasterView(), m_masterState, getSlaveView(), m_slaveState, m_type));
+}
+
+const std::string ebus::Telegram::toStringMaster() const
+{
+	return (formatMaster(getMasterView(), m_masterState));
+}
+
+const std::string ebus::Telegram::toStringSlave() const
+{
+	return (formatSlave(getSlaveView(), m_slaveState, m_type));
+}
+
+const std::string ebus::Telegram::format(const SequenceView &master, const int masterState, const SequenceView &slave,
+	const int slaveState, const Type type)
 {
 	std::ostringstream ostr;
 
-	ostr << toStringMaster();
+	ostr << formatMaster(master, masterState);
 
-	if (m_masterState == SEQ_OK && m_type == Type::MS) ostr << " " << toStringSlave();
+	if (masterState == SEQ_OK && type == Type::MS) ostr << " " << formatSlave(slave, slaveState, type);
 
 	return (ostr.str());
 }
 
-const std::string ebus::Telegram::toStringMaster()
+const std::string ebus::Telegram::formatMaster(const SequenceView &master, const int masterState)
 {
 	std::ostringstream ostr;
-	if (m_masterState != SEQ_OK)
-		ostr << toStringMasterError();
+
+	if (masterState != SEQ_OK)
+	{
+		if (master.size() > 0) ostr << "'" << hex(master) << "' ";
+
+		ostr << "master " << errorText(masterState);
+	}
 	else
-		ostr << m_master.to_string();
+	{
+		ostr << hex(master);
+	}
 
 	return (ostr.str());
 }
 
-const std::string ebus::Telegram::toStringSlave()
+const std::string ebus::Telegram::formatSlave(const SequenceView &slave, const int slaveState, const Type type)
 {
 	std::ostringstream ostr;
-	if (m_slaveState != SEQ_OK && m_type != Type::BC)
+
+	if (slaveState != SEQ_OK && type != Type::BC)
 	{
-		ostr << toStringSlaveError();
+		if (slave.size() > 0) ostr << "'" << hex(slave) << "' ";
+
+		ostr << "slave " << errorText(slaveState);
 	}
 	else
 	{
-		if (m_type == Type::MS) ostr << m_slave.to_string();
+		if (type == Type::MS) ostr << hex(slave);
 	}
 
 	return (ostr.str());
@@ -468,52 +632,32 @@ const std::string ebus::Telegram::toStringSlave()
 
 bool ebus::Telegram::isMaster(const std::byte byte)
 {
-	std::byte hi = (byte & std::byte(0xf0)) >> 4;
-	std::byte lo = (byte & std::byte(0x0f));
-
-	return (((hi == std::byte(0x0)) || (hi == std::byte(0x1)) || (hi == std::byte(0x3)) || (hi == std::byte(0x7))
-		|| (hi == std::byte(0xf)))
-		&& ((lo == std::byte(0x0)) || (lo == std::byte(0x1)) || (lo == std::byte(0x3)) || (lo == std::byte(0x7))
-			|| (lo == std::byte(0xf))));
+	return (protocol::is_master(byte));
 }
 
 bool ebus::Telegram::isSlave(const std::byte byte)
 {
-	return (!isMaster(byte) && byte != seq_syn && byte != seq_exp);
+	return (protocol::is_slave(byte));
 }
 
 std::byte ebus::Telegram::slaveAddress(const std::byte address)
 {
-	if (isSlave(address)) return (address);
-
-	return (std::byte(std::to_integer<int>(address) + 5));
+	return (protocol::slave_address(address));
 }
 
-const std::string ebus::Telegram::errorText(const int error)
+const std::string ebus::Telegram::hex(const SequenceView &view)
 {
-	std::ostringstream ostr;
-
-	ostr << SequenceErrors[error];
+	std::string result(2 * view.size(), '0');
+	hex::encode(view.data(), view.size(), result.data());
 
-	return (ostr.str());
+	return (result);
 }
 
-const std::string ebus::Telegram::toStringMasterError()
-{
-	std::ostringstream ostr;
-	if (m_master.size() > 0) ostr << "'" << m_master.to_string() << "' ";
-
-	ostr << "master " << errorText(m_masterState);
-
-	return (ostr.str());
-}
-
-const std::string ebus::Telegram::toStringSlaveError()
+const std::string ebus::Telegram::errorText(const int error)
 {
 	std::ostringstream ostr;
-	if (m_slave.size() > 0) ostr << "'" << m_slave.to_string() << "' ";
 
-	ostr << "slave " << errorText(m_slaveState);
+	ostr << SequenceErrors[error];
 
 	return (ostr.str());
 }
@@ -530,39 +674,91 @@ void ebus::Telegram::set_type(const std::byte byte)
 
 bool ebus::Telegram::isAddressValid(const std::byte byte)
 {
-	return (byte != seq_syn && byte != seq_exp);
+	return (protocol::is_valid(byte));
 }
 
-int ebus::Telegram::checkMasterSequence(Sequence &seq)
+int ebus::Telegram::checkMasterSequence(const std::byte *data, const size_t size)
 {
 	// sequence is too short
-	if (seq.size() < (size_t) 6) return (SEQ_ERR_SHORT);
+	if (size < (size_t) 6) return (SEQ_ERR_SHORT);
 
 	// source address is invalid
-	if (!isMaster(seq[0])) return (SEQ_ERR_QQ);
+	if (!isMaster(data[0])) return (SEQ_ERR_QQ);
 
 	// target address is invalid
-	if (!isAddressValid(seq[1])) return (SEQ_ERR_ZZ);
+	if (!isAddressValid(data[1])) return (SEQ_ERR_ZZ);
 
 	// number data byte is invalid
-	if (std::to_integer<int>(seq[4]) > seq_max_bytes) return (SEQ_ERR_NN);
+	if (std::to_integer<int>(data[4]) > seq_max_bytes) return (SEQ_ERR_NN);
 
 	// sequence is too short (incl. CRC)
-	if (seq.size() < (size_t) (5 + std::to_integer<int>(seq[4]) + 1)) return (SEQ_ERR_SHORT);
+	if (size < (size_t) (5 + std::to_integer<int>(data[4]) + 1)) return (SEQ_ERR_SHORT);
 
 	return (SEQ_OK);
 }
 
-int ebus::Telegram::checkSlaveSequence(Sequence &seq)
+int ebus::Telegram::checkSlaveSequence(const std::byte *data, const size_t size)
 {
 	// sequence is too short
-	if (seq.size() < (size_t) 2) return (SEQ_ERR_SHORT);
+	if (size < (size_t) 2) return (SEQ_ERR_SHORT);
 
 	// number data byte is invalid
-	if (std::to_integer<int>(seq[0]) > seq_max_bytes) return (SEQ_ERR_NN);
+	if (std::to_integer<int>(data[0]) > seq_max_bytes) return (SEQ_ERR_NN);
 
 	// sequence is too short (incl. CRC)
-	if (seq.size() < (size_t) (1 + std::to_integer<int>(seq[0]) + 1)) return (SEQ_ERR_SHORT);
+	if (size < (size_t) (1 + std::to_integer<int>(data[0]) + 1)) return (SEQ_ERR_SHORT);
 
 	return (SEQ_OK);
 }
+
+void ebus::Telegram::setMaster(const size_t offset)
+{
+	const std::byte *data = m_source + offset;
+
+	m_masterState = SEQ_OK;
+
+	set_type(data[1]);
+	m_masterNN = (size_t) std::to_integer<int>(data[4]);
+
+	m_masterOffset = offset;
+	m_masterSize = 5 + m_masterNN;
+	m_masterCRC = data[m_masterSize];
+
+	// sequence has a CRC error
+	m_masterCRCValid = reducedCRC(data, m_masterSize) == m_masterCRC;
+	if (!m_masterCRCValid) m_masterState = SEQ_ERR_CRC;
+}
+
+void ebus::Telegram::setSlave(const size_t offset)
+{
+	const std::byte *data = m_source + offset;
+
+	m_slaveState = SEQ_OK;
+
+	m_slaveNN = (size_t) std::to_integer<int>(data[0]);
+
+	m_slaveOffset = offset;
+	m_slaveSize = 1 + m_slaveNN;
+	m_slaveCRC = data[m_slaveSize];
+
+	// sequence has a CRC error
+	m_slaveCRCValid = reducedCRC(data, m_slaveSize) == m_slaveCRC;
+	if (!m_slaveCRCValid) m_slaveState = SEQ_ERR_CRC;
+}
+
+std::byte ebus::Telegram::reducedCRC(const std::byte *data, const size_t size)
+{
+	std::byte crc = seq_zero;
+	std::byte bytes[2];
+
+	// crc covers the extended bytes
+	for (size_t i = 0; i < size; i++)
+	{
+		size_t count = EscapeEncoder::encode(data[i], bytes);
+
+		for (size_t j = 0; j < count; j++)
+			crc = Crc::update(bytes[j], crc);
+	}
+
+	return (crc);
+}
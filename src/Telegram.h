@@ -20,6 +20,7 @@
 #ifndef EBUS_TELEGRAM_H
 #define EBUS_TELEGRAM_H
 
+#include <chrono>
 #include <cstddef>
 #include <string>
 #include <vector>
@@ -64,8 +65,16 @@ public:
 	Telegram() = default;
 	explicit Telegram(Sequence &seq);
 
+	// copies own their master and slave, a parsed telegram is materialized before it is copied
+	Telegram(const Telegram &other);
+	Telegram& operator=(const Telegram &other);
+
 	void parse(Sequence &seq);
 
+	// single pass over a reduced buffer: master and slave are kept as offsets into data (which has
+	// to outlive the telegram or its views until it is copied) and are copied on request only
+	void parse(const std::byte *data, const size_t size);
+
 	void createMaster(const std::byte src, const std::vector<std::byte> &vec);
 	void createMaster(Sequence &seq);
 
@@ -76,25 +85,43 @@ public:
 
 	std::byte getMasterQQ() const;
 
-	Sequence getMaster() const;
+	const Sequence& getMaster() const;
+	SequenceView getMasterView() const;
 	std::byte getMasterCRC() const;
+	bool isMasterCRCValid() const;
 	int getMasterState() const;
 
 	void setSlaveACK(const std::byte byte);
 
-	Sequence getSlave() const;
+	const Sequence& getSlave() const;
+	SequenceView getSlaveView() const;
 	std::byte getSlaveCRC() const;
+	bool isSlaveCRCValid() const;
 	int getSlaveState() const;
 
 	void setMasterACK(const std::byte byte);
 
 	ebus::Type get_type() const;
 
+	void setTime(const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end);
+
+	const std::chrono::steady_clock::time_point& getBeginTime() const;
+	const std::chrono::steady_clock::time_point& getEndTime() const;
+
 	bool isValid() const;
 
-	const std::string to_string();
-	const std::string toStringMaster();
-	const std::string toStringSlave();
+	const std::string to_string() const;
+	const std::string toStringMaster() const;
+	const std::string toStringSlave() const;
+
+	// text of a telegram from its parts, as to_string
+	static const std::string format(const SequenceView &master, const int masterState, const SequenceView &slave,
+		const int slaveState, const Type type);
+
+	static const std::string formatMaster(const SequenceView &master, const int masterState);
+	static const std::string formatSlave(const SequenceView &slave, const int slaveState, const Type type);
+
+	static const std::string hex(const SequenceView &view);
 
 	static bool isMaster(const std::byte byte);
 	static bool isSlave(const std::byte byte);
@@ -103,29 +130,47 @@ public:
 private:
 	Type m_type = Type::undefined;
 
-	Sequence m_master;
+	// parts of a parsed buffer, copied into m_master and m_slave on request
+	mutable const std::byte *m_source = nullptr;
+	size_t m_masterOffset = 0;
+	size_t m_masterSize = 0;
+	size_t m_slaveOffset = 0;
+	size_t m_slaveSize = 0;
+
+	mutable Sequence m_master;
 	size_t m_masterNN = 0;
 	std::byte m_masterCRC = seq_zero;
+	bool m_masterCRCValid = false;
 	int m_masterState = SEQ_EMPTY;
 
 	std::byte m_slaveACK = seq_zero;
 
-	Sequence m_slave;
+	mutable Sequence m_slave;
 	size_t m_slaveNN = 0;
 	std::byte m_slaveCRC = seq_zero;
+	bool m_slaveCRCValid = false;
 	int m_slaveState = SEQ_EMPTY;
 
 	std::byte m_masterACK = seq_zero;
 
-	const std::string errorText(const int error);
+	// receive time of first and last byte
+	std::chrono::steady_clock::time_point m_begin;
+	std::chrono::steady_clock::time_point m_end;
+
+	static const std::string errorText(const int error);
 
-	const std::string toStringMasterError();
-	const std::string toStringSlaveError();
+	// crc of reduced bytes as they are sent extended
+	static std::byte reducedCRC(const std::byte *data, const size_t size);
 
 	void set_type(const std::byte byte);
 	bool isAddressValid(const std::byte byte);
-	int checkMasterSequence(Sequence &seq);
-	int checkSlaveSequence(Sequence &seq);
+	int checkMasterSequence(const std::byte *data, const size_t size);
+	int checkSlaveSequence(const std::byte *data, const size_t size);
+
+	void setMaster(const size_t offset);
+	void setSlave(const size_t offset);
+
+	void materialize() const;
 };
 
 } // namespace ebus
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "TelegramBatch.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Escape.h"
+#include "EscapeScan.h"
+
+// parts which are split at once
+static const size_t split_block = 4096;
+
+// bytes of a worker at least, smaller batches are not worth a thread
+static const size_t worker_min = 131072;
+
+namespace ebus
+{
+
+// workers kept for all batches of the process, grown on demand; the calling thread runs job 0
+class BatchPool
+{
+
+public:
+	BatchPool() = default;
+	~BatchPool();
+
+	BatchPool(const BatchPool&) = delete;
+	BatchPool& operator=(const BatchPool&) = delete;
+
+	// runs job(0) .. job(jobs - 1) at the same time and returns when all of them are done
+	void run(const unsigned jobs, const std::function<void(unsigned)> &job);
+
+private:
+	std::mutex m_run;
+	std::mutex m_mutex;
+	std::condition_variable m_start;
+	std::condition_variable m_done;
+	std::vector<std::thread> m_workers;
+
+	const std::function<void(unsigned)> *m_job = nullptr;
+	unsigned m_jobs = 0;
+	unsigned m_pending = 0;
+	size_t m_generation = 0;
+	bool m_stop = false;
+
+	void work(const unsigned index, size_t generation);
+};
+
+// SYN aligned byte range of the stream and its parts, split by one worker
+struct BatchSlice
+{
+	size_t begin = 0;
+	size_t end = 0;
+
+	size_t first = 0;
+	size_t count = 0;
+
+	std::vector<size_t> offset;
+	std::vector<size_t> length;
+};
+
+} // namespace ebus
+
+static ebus::BatchPool& pool()
+{
+	static ebus::BatchPool pool;
+
+	return (pool);
+}
+
+ebus::BatchPool::~BatchPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_start.notify_all();
+
+	for (std::thread &worker : m_workers)
+		worker.join();
+}
+
+void ebus::BatchPool::run(const unsigned jobs, const std::function<void(unsigned)> &job)
+{
+	std::lock_guard<std::mutex> run(m_run);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		while (m_workers.size() + 1 < jobs)
+			m_workers.emplace_back(&BatchPool::work, this, unsigned(m_workers.size() + 1), m_generation);
+
+		m_job = &job;
+		m_jobs = jobs;
+		m_pending = jobs - 1;
+		m_generation++;
+	}
+
+	m_start.notify_all();
+
+	job(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this]() { return (m_pending == 0); });
+
+	m_job = nullptr;
+}
+
+void ebus::BatchPool::work(const unsigned index, size_t generation)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_start.wait(lock, [this, generation]() { return (m_stop || m_generation != generation); });
+
+		if (m_stop) return;
+
+		generation = m_generation;
+		if (index >= m_jobs) continue;
+
+		const std::function<void(unsigned)> &job = *m_job;
+
+		lock.unlock();
+		job(index);
+		lock.lock();
+
+		if (--m_pending == 0) m_done.notify_one();
+	}
+}
+
+static void split(const std::byte *data, ebus::BatchSlice &slice)
+{
+	size_t pos = slice.begin;
+	slice.count = 0;
+
+	while (pos < slice.end)
+	{
+		slice.offset.resize(slice.count + split_block);
+		slice.length.resize(slice.count + split_block);
+
+		size_t next = 0;
+		const size_t parts = ebus::EscapeScan::split(data + pos, slice.end - pos, slice.offset.data() + slice.count,
+			slice.length.data() + slice.count, split_block, next);
+
+		for (size_t i = slice.count; i < slice.count + parts; i++)
+			slice.offset[i] += pos;
+
+		slice.count += parts;
+
+		pos += next;
+	}
+}
+
+size_t ebus::TelegramBatch::count() const
+{
+	return (offset.size());
+}
+
+void ebus::TelegramBatch::resize(const size_t count)
+{
+	offset.resize(count);
+	length.resize(count);
+	type.resize(count);
+	qq.resize(count);
+	zz.resize(count);
+	pb.resize(count);
+	sb.resize(count);
+	master_state.resize(count);
+	slave_state.resize(count);
+	master_crc.resize(count);
+	slave_crc.resize(count);
+}
+
+void ebus::TelegramBatch::clear()
+{
+	resize(0);
+}
+
+size_t ebus::TelegramBatch::parse(const std::byte *data, const size_t size, unsigned threads)
+{
+	// the stream is incomplete after its last SYN
+	size_t end = size;
+	while (end > 0 && data[end - 1] != seq_syn)
+		end--;
+
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = unsigned(std::min(size_t(threads), std::max(size_t(1), end / worker_min)));
+
+	// each worker starts after the first SYN of its share of the stream
+	std::vector<BatchSlice> slices(threads);
+
+	for (unsigned i = 1; i < threads; i++)
+	{
+		size_t begin = std::max(slices[i - 1].begin, end / threads * i);
+
+		while (begin < end && data[begin - 1] != seq_syn)
+			begin++;
+
+		slices[i].begin = begin;
+		slices[i - 1].end = begin;
+	}
+
+	slices[threads - 1].end = end;
+
+	const auto run = [threads](const std::function<void(unsigned)> &job)
+	{
+		if (threads == 1)
+			job(0);
+		else
+			pool().run(threads, job);
+	};
+
+	run([data, &slices](unsigned i)
+	{
+		split(data, slices[i]);
+	});
+
+	size_t count = 0;
+
+	for (BatchSlice &slice : slices)
+	{
+		slice.first = count;
+		count += slice.count;
+	}
+
+	resize(count);
+
+	run([this, data, &slices](unsigned i)
+	{
+		const BatchSlice &slice = slices[i];
+
+		std::copy(slice.offset.begin(), slice.offset.begin() + slice.count, offset.begin() + slice.first);
+		std::copy(slice.length.begin(), slice.length.begin() + slice.count, length.begin() + slice.first);
+
+		parse(data, slice.first, slice.first + slice.count);
+	});
+
+	return (end);
+}
+
+void ebus::TelegramBatch::parse(const std::byte *data, const size_t begin, const size_t end)
+{
+	std::array<std::byte, Sequence::capacity> reduced;
+	Telegram tel;
+
+	for (size_t i = begin; i < end; i++)
+	{
+		// the monitor drops collected bytes each time its sequence is full
+		size_t len = length[i];
+		if (len > Sequence::capacity) len = (len - 1) % Sequence::capacity + 1;
+
+		const size_t count = EscapeDecoder::decode(data + offset[i] + length[i] - len, len, reduced.data());
+
+		tel.parse(reduced.data(), count);
+
+		const SequenceView master = tel.getMasterView();
+
+		// header of the last master part or of the raw bytes
+		const std::byte *header = master.empty() ? reduced.data() : master.data();
+		const size_t available = master.empty() ? count : master.size();
+
+		type[i] = tel.get_type();
+		qq[i] = available > 0 ? header[0] : seq_zero;
+		zz[i] = available > 1 ? header[1] : seq_zero;
+		pb[i] = available > 2 ? header[2] : seq_zero;
+		sb[i] = available > 3 ? header[3] : seq_zero;
+
+		master_state[i] = std::int8_t(tel.getMasterState());
+		slave_state[i] = std::int8_t(tel.getSlaveState());
+
+		master_crc[i] = tel.isMasterCRCValid();
+		slave_crc[i] = tel.isSlaveCRCValid();
+	}
+}
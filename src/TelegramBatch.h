@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_TELEGRAMBATCH_H
+#define EBUS_TELEGRAMBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Telegram.h"
+
+namespace ebus
+{
+
+// parse results of a raw stream as struct of arrays, entry i describes the i-th SYN terminated part
+struct TelegramBatch
+{
+	// raw part (without SYN) in the parsed stream
+	std::vector<size_t> offset;
+	std::vector<size_t> length;
+
+	std::vector<Type> type;
+
+	// header of the (last) master part, zero if the part is too short
+	std::vector<std::byte> qq;
+	std::vector<std::byte> zz;
+	std::vector<std::byte> pb;
+	std::vector<std::byte> sb;
+
+	// states as Telegram::getMasterState and Telegram::getSlaveState
+	std::vector<std::int8_t> master_state;
+	std::vector<std::int8_t> slave_state;
+
+	// 1 if the part is present and its CRC is correct
+	std::vector<std::uint8_t> master_crc;
+	std::vector<std::uint8_t> slave_crc;
+
+	size_t count() const;
+
+	void resize(const size_t count);
+	void clear();
+
+	// splits a raw stream at SYN and parses the parts like the bus monitor does on up to threads
+	// workers of a pool kept for the process (0 = all cores), each of them takes a SYN aligned share
+	// of the stream; returns the position after the last SYN, the rest is incomplete and has to be
+	// passed again with the following bytes of the stream
+	size_t parse(const std::byte *data, const size_t size, unsigned threads = 0);
+
+private:
+	void parse(const std::byte *data, const size_t begin, const size_t end);
+};
+
+} // namespace ebus
+
+#endif // EBUS_TELEGRAMBATCH_H
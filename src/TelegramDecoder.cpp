@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "TelegramDecoder.h"
+
+#include "../include/ebus/Protocol.h"
+
+bool ebus::TelegramDecoder::feed(const std::byte byte)
+{
+	std::byte reduced;
+
+	if (!m_escape.feed(byte, reduced)) return (false);
+
+	if (m_state == State::complete) m_state = State::trailing;
+
+	// the monitor drops its bytes before the reduced ones can overflow
+	if (m_size == m_data.size())
+	{
+		if (m_state != State::trailing) m_state = State::failed;
+		return (false);
+	}
+
+	m_data[m_size++] = reduced;
+
+	if (m_state == State::trailing || m_state == State::ended || m_state == State::failed) return (false);
+
+	next(reduced);
+
+	if (m_state != State::complete) return (false);
+
+	m_length = m_size;
+
+	return (true);
+}
+
+void ebus::TelegramDecoder::reset()
+{
+	m_escape.reset();
+	m_size = 0;
+	m_length = 0;
+	m_type = Type::undefined;
+	m_masterRetry = false;
+	m_slaveRetry = false;
+
+	start(State::master, 0);
+}
+
+ebus::TelegramDecoder::State ebus::TelegramDecoder::state() const
+{
+	return (m_state);
+}
+
+const std::byte* ebus::TelegramDecoder::data() const
+{
+	return (m_data.data());
+}
+
+size_t ebus::TelegramDecoder::size() const
+{
+	return (m_size);
+}
+
+size_t ebus::TelegramDecoder::length() const
+{
+	return (m_length);
+}
+
+void ebus::TelegramDecoder::next(const std::byte byte)
+{
+	const size_t index = m_size - 1;
+
+	switch (m_state)
+	{
+	case State::master:
+	{
+		const size_t pos = index - m_begin;
+
+		if (pos == 0 && !protocol::is_master(byte))
+			m_state = State::failed;
+		else if (pos == 1 && !protocol::is_valid(byte))
+			m_state = State::failed;
+		else if (pos == 1)
+			m_type = byte == seq_broad ? Type::BC : protocol::is_master(byte) ? Type::MM : Type::MS;
+		else if (pos == 4 && std::to_integer<int>(byte) > seq_max_bytes)
+			m_state = State::failed;
+		else if (pos == 4)
+			m_end = m_begin + 5 + std::to_integer<size_t>(byte) + 1;
+		else if (m_size == m_end)
+			start(m_type == Type::BC ? State::complete : State::slave_ack, m_size);
+
+		break;
+	}
+	case State::slave_ack:
+		if (byte == seq_ack)
+			start(m_type == Type::MM ? State::complete : State::slave, m_size);
+		else if (byte == seq_nak && !m_masterRetry)
+		{
+			m_masterRetry = true;
+			start(State::master, m_size);
+		}
+		else
+			m_state = State::failed;
+
+		break;
+	case State::slave:
+	{
+		// a repeated slave part follows one byte after the NAK of the master
+		if (index < m_begin) break;
+
+		const size_t pos = index - m_begin;
+
+		if (pos == 0 && std::to_integer<int>(byte) > seq_max_bytes)
+			m_state = State::failed;
+		else if (pos == 0)
+			m_end = m_begin + 1 + std::to_integer<size_t>(byte) + 1;
+		else if (m_size == m_end)
+			start(State::master_ack, m_size);
+
+		break;
+	}
+	case State::master_ack:
+		if (byte == seq_ack)
+			m_state = m_slaveRetry ? State::ended : State::complete;
+		else if (byte == seq_nak && !m_slaveRetry)
+		{
+			m_slaveRetry = true;
+			start(State::slave, m_size + 1);
+		}
+		else
+			m_state = State::failed;
+
+		break;
+	default:
+		break;
+	}
+}
+
+void ebus::TelegramDecoder::start(const State state, const size_t begin)
+{
+	m_state = state;
+	m_begin = begin;
+	m_end = 0;
+}
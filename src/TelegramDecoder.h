@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_TELEGRAMDECODER_H
+#define EBUS_TELEGRAMDECODER_H
+
+#include <array>
+#include <cstddef>
+
+#include "Escape.h"
+#include "Sequence.h"
+#include "Telegram.h"
+
+namespace ebus
+{
+
+// push decoder of the bytes between two SYN: follows master, acknowledges, slave and NAK retries
+// byte by byte and reports the end of a telegram with its last byte; the reduced bytes are kept
+// in any state, so they can be parsed as a whole when no telegram was completed
+class TelegramDecoder
+{
+
+public:
+	enum class State
+	{
+		master,		// QQ ZZ PB SB NN DBx CRC
+		slave_ack,	// ACK of the slave
+		slave,		// NN DBx CRC
+		master_ack,	// ACK of the master
+		complete,	// telegram ended with its last byte, more bytes are not expected
+		trailing,	// bytes followed the completed telegram, waits for SYN
+		ended,		// telegram ended after a repeated slave part, bytes after it make it invalid
+				// so it is not reported and has to be parsed as a whole at SYN
+		failed		// telegram can not complete, waits for SYN
+	};
+
+	// returns true when the byte completed the telegram
+	bool feed(const std::byte byte);
+
+	void reset();
+
+	State state() const;
+
+	// reduced bytes since reset
+	const std::byte* data() const;
+	size_t size() const;
+
+	// reduced bytes of the completed telegram, 0 if none
+	size_t length() const;
+
+private:
+	EscapeDecoder m_escape;
+
+	std::array<std::byte, Sequence::capacity> m_data = {};
+	size_t m_size = 0;
+	size_t m_length = 0;
+
+	State m_state = State::master;
+	Type m_type = Type::undefined;
+
+	// first byte and end (0 = not yet known) of the current part
+	size_t m_begin = 0;
+	size_t m_end = 0;
+
+	bool m_masterRetry = false;
+	bool m_slaveRetry = false;
+
+	void next(const std::byte byte);
+	void start(const State state, const size_t begin);
+};
+
+} // namespace ebus
+
+#endif // EBUS_TELEGRAMDECODER_H
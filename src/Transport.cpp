@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "Transport.h"
+
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <stdexcept>
+
+#include "EnhancedTransport.h"
+#include "ReplayTransport.h"
+#include "SerialTransport.h"
+#include "TcpTransport.h"
+
+static const std::string prefix_tcp = "tcp:";
+static const std::string prefix_enh = "enh:";
+static const std::string prefix_replay = "replay:";
+static const std::string prefix_replay_paced = "replay-paced:";
+
+int ebus::Transport::poll(const short events, const struct timespec *timeout, short &revents)
+{
+	struct pollfd fds = {};
+
+	fds.fd = fd();
+	fds.events = events;
+
+	int ret = ppoll(&fds, 1, timeout, nullptr);
+
+	revents = fds.revents;
+
+	return (ret);
+}
+
+ssize_t ebus::Transport::read(std::byte *data, const size_t size)
+{
+	return (::read(fd(), data, size));
+}
+
+ssize_t ebus::Transport::write(const std::byte *data, const size_t size)
+{
+	return (::write(fd(), data, size));
+}
+
+bool ebus::Transport::timestamp(std::chrono::steady_clock::time_point &time)
+{
+	(void) time;
+	return (false);
+}
+
+bool ebus::Transport::check(DeviceCounters &counters)
+{
+	counters.supported = false;
+	return (true);
+}
+
+void ebus::Transport::lowLatency(const bool enable, LowLatency &state)
+{
+	state = LowLatency();
+	state.enabled = enable;
+}
+
+bool ebus::Transport::explicitOpen() const
+{
+	return (false);
+}
+
+bool ebus::Transport::arbitration() const
+{
+	return (false);
+}
+
+void ebus::Transport::arbitrate(const std::byte address)
+{
+	(void) address;
+	throw std::logic_error("The transport does not support arbitration");
+}
+
+ebus::Arbitration ebus::Transport::arbitrationResult(std::byte &address)
+{
+	(void) address;
+	return (Arbitration::pending);
+}
+
+std::unique_ptr<ebus::Transport> ebus::Transport::create(const std::string &device)
+{
+	// enhanced adapters talk 9600 baud on serial lines
+	if (device.compare(0, prefix_enh.size(), prefix_enh) == 0)
+	{
+		const std::string inner = device.substr(prefix_enh.size());
+
+		if (inner.compare(0, prefix_tcp.size(), prefix_tcp) == 0)
+			return (std::make_unique<EnhancedTransport>(create(inner)));
+
+		return (std::make_unique<EnhancedTransport>(std::make_unique<SerialTransport>(inner, B9600)));
+	}
+
+	if (device.compare(0, prefix_tcp.size(), prefix_tcp) == 0)
+		return (std::make_unique<TcpTransport>(device.substr(prefix_tcp.size())));
+
+	// raw capture files: as fast as possible or paced to 2400 baud
+	if (device.compare(0, prefix_replay.size(), prefix_replay) == 0)
+		return (std::make_unique<ReplayTransport>(device.substr(prefix_replay.size()), false));
+
+	if (device.compare(0, prefix_replay_paced.size(), prefix_replay_paced) == 0)
+		return (std::make_unique<ReplayTransport>(device.substr(prefix_replay_paced.size()), true));
+
+	return (std::make_unique<SerialTransport>(device));
+}
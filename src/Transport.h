@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_TRANSPORT_H
+#define EBUS_TRANSPORT_H
+
+#include <sys/types.h>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include "../include/ebus/Ebus.h"
+
+namespace ebus
+{
+
+// result of an arbitration done by the adapter
+enum class Arbitration
+{
+	pending,	// no result reported yet
+	won,		// own address is on the bus
+	lost		// address of another master is on the bus
+};
+
+class Transport
+{
+
+public:
+	virtual ~Transport() = default;
+
+	virtual void open() = 0;
+	virtual void close() = 0;
+
+	virtual int fd() const = 0;
+
+	// opened by an explicit open() only, not when the bus thread starts
+	virtual bool explicitOpen() const;
+
+	virtual int poll(const short events, const struct timespec *timeout, short &revents);
+
+	virtual ssize_t read(std::byte *data, const size_t size);
+	virtual ssize_t write(const std::byte *data, const size_t size);
+
+	virtual bool timestamp(std::chrono::steady_clock::time_point &time);
+
+	virtual bool check(DeviceCounters &counters);
+
+	virtual void lowLatency(const bool enable, LowLatency &state);
+
+	virtual bool arbitration() const;
+	virtual void arbitrate(const std::byte address);
+
+	// result of the last arbitrate() with the address seen on the bus, taken once it was reported
+	virtual Arbitration arbitrationResult(std::byte &address);
+
+	static std::unique_ptr<Transport> create(const std::string &device);
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_TRANSPORT_H
@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include "VirtualBus.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <ctime>
+#include <stdexcept>
+
+#include "EnhancedTransport.h"
+#include "Telegram.h"
+
+static long elapsed(const struct timespec &since)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((now.tv_sec - since.tv_sec) * 1000000L + (now.tv_nsec - since.tv_nsec) / 1000L);
+}
+
+ebus::VirtualBus::VirtualBus(const long syn_interval, const bool enhanced) : m_synInterval(syn_interval), m_enhanced(
+	enhanced)
+{
+	m_master = posix_openpt(O_RDWR | O_NOCTTY);
+
+	if (m_master < 0 || grantpt(m_master) != 0 || unlockpt(m_master) != 0 || ptsname(m_master) == nullptr)
+		throw std::runtime_error("An error occurred while creating the virtual bus");
+
+	m_name = ptsname(m_master);
+
+	// an unread bus must not block the simulation
+	fcntl(m_master, F_SETFL, fcntl(m_master, F_GETFL) | O_NONBLOCK);
+
+	// keep the slave side open and raw, so the pty survives reopening of the device
+	m_slave = ::open(m_name.c_str(), O_RDWR | O_NOCTTY);
+	if (m_slave < 0) throw std::runtime_error("An error occurred while opening the virtual bus");
+
+	struct termios settings;
+	tcgetattr(m_slave, &settings);
+	cfmakeraw(&settings);
+	tcsetattr(m_slave, TCSANOW, &settings);
+}
+
+ebus::VirtualBus::~VirtualBus()
+{
+	stop();
+
+	if (m_slave >= 0) ::close(m_slave);
+	if (m_master >= 0) ::close(m_master);
+}
+
+void ebus::VirtualBus::start()
+{
+	if (m_running) return;
+
+	m_running = true;
+	m_thread = std::thread(&VirtualBus::run, this);
+}
+
+void ebus::VirtualBus::stop()
+{
+	m_running = false;
+
+	if (m_thread.joinable()) m_thread.join();
+}
+
+const std::string ebus::VirtualBus::name() const
+{
+	return (m_name);
+}
+
+void ebus::VirtualBus::add_response(const std::vector<std::byte> &message, const std::vector<std::byte> &response)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_responses[message] = response;
+}
+
+void ebus::VirtualBus::add_master(const std::vector<std::byte> &telegram, const size_t interval)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_foreign = telegram;
+	m_foreignInterval = interval;
+}
+
+size_t ebus::VirtualBus::syn_count() const
+{
+	return (m_synCount);
+}
+
+size_t ebus::VirtualBus::telegram_count() const
+{
+	return (m_telegramCount);
+}
+
+void ebus::VirtualBus::run()
+{
+	struct timespec last;
+	clock_gettime(CLOCK_MONOTONIC, &last);
+
+	std::byte buffer[256];
+
+	while (m_running)
+	{
+		long remain = m_synInterval - elapsed(last);
+
+		// bus was idle long enough: generate SYN
+		if (remain <= 0)
+		{
+			send(seq_syn);
+			handle(seq_syn);
+
+			m_synCount++;
+
+			arbitrate();
+
+			clock_gettime(CLOCK_MONOTONIC, &last);
+			continue;
+		}
+
+		struct pollfd fds = {};
+		fds.fd = m_master;
+		fds.events = POLLIN;
+
+		// wake up regularly to notice stop()
+		if (remain > 100000L) remain = 100000L;
+
+		struct timespec tdiff =
+		{ remain / 1000000L, (remain % 1000000L) * 1000L };
+
+		if (ppoll(&fds, 1, &tdiff, nullptr) <= 0) continue;
+
+		ssize_t nbytes = ::read(m_master, buffer, sizeof(buffer));
+		if (nbytes <= 0) continue;
+
+		if (m_enhanced)
+		{
+			for (ssize_t i = 0; i < nbytes; i++)
+				decode(buffer[i]);
+		}
+		else
+		{
+			// every byte on the bus is received by all participants
+			send(buffer, nbytes);
+
+			for (ssize_t i = 0; i < nbytes; i++)
+				handle(buffer[i]);
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &last);
+	}
+}
+
+void ebus::VirtualBus::arbitrate()
+{
+	std::vector<std::byte> foreign;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_foreignInterval != 0 && m_synCount % m_foreignInterval == 0) foreign = m_foreign;
+	}
+
+	// requested arbitration takes place directly after SYN, the lower address wins
+	if (m_arbitration && (foreign.empty() || m_address < foreign[0]))
+	{
+		m_arbitration = false;
+
+		reply(enh_res_started, m_address);
+		handle(m_address);
+		return;
+	}
+
+	if (foreign.empty()) return;
+
+	size_t begin = 0;
+
+	if (m_arbitration)
+	{
+		m_arbitration = false;
+
+		reply(enh_res_failed, foreign[0]);
+		handle(foreign[0]);
+		begin = 1;
+	}
+
+	for (size_t i = begin; i < foreign.size(); i++)
+	{
+		send(foreign[i]);
+		handle(foreign[i]);
+	}
+}
+
+void ebus::VirtualBus::send(const std::byte byte)
+{
+	// enhanced: received data bytes below 0x80 are transferred without framing
+	if (m_enhanced && (byte & std::byte(0x80)) != seq_zero)
+	{
+		reply(enh_res_received, byte);
+		return;
+	}
+
+	ssize_t ret = ::write(m_master, &byte, 1);
+	(void) ret;
+}
+
+void ebus::VirtualBus::send(const std::byte *data, const size_t size)
+{
+	if (m_enhanced)
+	{
+		for (size_t i = 0; i < size; i++)
+			send(data[i]);
+
+		return;
+	}
+
+	ssize_t ret = ::write(m_master, data, size);
+	(void) ret;
+}
+
+void ebus::VirtualBus::reply(const int command, const std::byte data)
+{
+	std::byte frame[2];
+	EnhancedTransport::encode(command, data, frame);
+
+	ssize_t ret = ::write(m_master, frame, sizeof(frame));
+	(void) ret;
+}
+
+void ebus::VirtualBus::decode(const std::byte byte)
+{
+	if ((byte & std::byte(0xc0)) == std::byte(0xc0))
+	{
+		m_pending = true;
+		m_first = byte;
+		return;
+	}
+
+	if (!m_pending) return;
+
+	m_pending = false;
+
+	const int command = std::to_integer<int>(m_first >> 2) & 0x0f;
+	const std::byte data = ((m_first & std::byte(0x03)) << 6) | (byte & std::byte(0x3f));
+
+	switch (command)
+	{
+	case enh_req_init:
+		reply(enh_res_resetted, seq_zero);
+		break;
+	case enh_req_send:
+		send(data);
+		handle(data);
+		break;
+	case enh_req_start:
+		// SYN as address cancels a requested arbitration
+		m_arbitration = (data != seq_syn);
+		m_address = data;
+		break;
+	case enh_req_info:
+	default:
+		break;
+	}
+}
+
+void ebus::VirtualBus::handle(const std::byte byte)
+{
+	if (byte == seq_syn)
+	{
+		m_state = State::Master;
+		m_sequence.clear();
+		return;
+	}
+
+	switch (m_state)
+	{
+	case State::Master:
+		m_sequence.push_back(byte);
+		handleMaster();
+		break;
+	case State::Response:
+		// negative acknowledge from master: repeat slave part once
+		if (byte == seq_nak && m_retry-- > 0)
+			send(m_response.data(), m_response.size());
+		else
+			m_state = State::Done;
+
+		break;
+	case State::Done:
+	default:
+		break;
+	}
+}
+
+void ebus::VirtualBus::handleMaster()
+{
+	Sequence seq(m_sequence, 0);
+	seq.reduce();
+
+	// wait for complete master part incl. CRC
+	if (seq.size() < 6 || seq.size() != (size_t) (5 + std::to_integer<int>(seq[4]) + 1)) return;
+
+	Telegram tel;
+	tel.createMaster(seq);
+
+	const std::vector<std::byte> message = seq.range(1, 4 + std::to_integer<size_t>(seq[4]));
+
+	std::vector<std::byte> response;
+	bool found = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::map<std::vector<std::byte>, std::vector<std::byte>>::const_iterator it = m_responses.find(message);
+
+		if (it != m_responses.end())
+		{
+			response = it->second;
+			found = true;
+		}
+	}
+
+	// unknown target: no participant answers
+	if (!found || tel.get_type() == Type::BC)
+	{
+		if (tel.get_type() == Type::BC) m_telegramCount++;
+
+		m_state = State::Done;
+		return;
+	}
+
+	if (tel.getMasterState() != SEQ_OK)
+	{
+		// master repeats the telegram after a negative acknowledge
+		send(seq_nak);
+		m_sequence.clear();
+		return;
+	}
+
+	send(seq_ack);
+
+	m_telegramCount++;
+
+	if (tel.get_type() != Type::MS)
+	{
+		m_state = State::Done;
+		return;
+	}
+
+	tel.createSlave(response);
+
+	// slave part incl. CRC in transmission format
+	Sequence slave;
+	slave.assign(response, false);
+	slave.push_back(tel.getSlaveCRC(), false);
+	slave.extend();
+
+	m_response = slave.get_sequence();
+	m_retry = 1;
+
+	send(m_response.data(), m_response.size());
+
+	m_state = State::Response;
+}
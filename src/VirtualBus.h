@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef EBUS_VIRTUALBUS_H
+#define EBUS_VIRTUALBUS_H
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Sequence.h"
+
+namespace ebus
+{
+
+// pseudo terminal bus simulation: the slave side of the pty behaves like an ebus adapter
+// (enhanced: like an adapter speaking the enhanced protocol incl. arbitration)
+class VirtualBus
+{
+
+public:
+	explicit VirtualBus(const long syn_interval = 10000L, const bool enhanced = false);
+	~VirtualBus();
+
+	void start();
+	void stop();
+
+	const std::string name() const;
+
+	void add_response(const std::vector<std::byte> &message, const std::vector<std::byte> &response);
+
+	// another master sending telegram (extended, QQ to CRC) directly after every interval-th SYN: it wins
+	// an arbitration requested for the same SYN by priority and delays one requested during its telegram
+	void add_master(const std::vector<std::byte> &telegram, const size_t interval);
+
+	size_t syn_count() const;
+	size_t telegram_count() const;
+
+private:
+	enum class State
+	{
+		Master,		// collecting master part
+		Response,	// slave part sent, waiting for master acknowledge
+		Done		// ignoring bytes until next SYN
+	};
+
+	const long m_synInterval;
+	const bool m_enhanced;
+
+	int m_master = -1;
+	int m_slave = -1;
+	std::string m_name;
+
+	std::thread m_thread;
+	std::atomic<bool> m_running = false;
+
+	std::atomic<size_t> m_synCount = 0;
+	std::atomic<size_t> m_telegramCount = 0;
+
+	std::map<std::vector<std::byte>, std::vector<std::byte>> m_responses;
+	std::vector<std::byte> m_foreign;
+	size_t m_foreignInterval = 0;
+	std::mutex m_mutex;
+
+	State m_state = State::Master;
+	Sequence m_sequence;
+	std::vector<std::byte> m_response;
+	int m_retry = 0;
+
+	// enhanced protocol
+	bool m_pending = false;
+	std::byte m_first = seq_zero;
+	bool m_arbitration = false;
+	std::byte m_address = seq_zero;
+
+	void run();
+
+	void arbitrate();
+
+	void send(const std::byte byte);
+	void send(const std::byte *data, const size_t size);
+
+	void reply(const int command, const std::byte data);
+	void decode(const std::byte byte);
+
+	void handle(const std::byte byte);
+	void handleMaster();
+
+};
+
+} // namespace ebus
+
+#endif // EBUS_VIRTUALBUS_H
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../src/Sequence.h"
+#include "../src/Telegram.h"
+
+static long allocations = 0;
+
+void* operator new(std::size_t size)
+{
+	allocations++;
+
+	void *ptr = std::malloc(size);
+	if (ptr == nullptr) throw std::bad_alloc();
+
+	return (ptr);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+static void report(const std::string &name, const long count, const bool valid)
+{
+	std::cout << name << ": allocations = " << count << " valid = " << valid << std::endl;
+}
+
+int main()
+{
+	const int repeat = 1000;
+
+	const std::vector<std::byte> raw = ebus::Ebus::to_vector("ff52b509030d0600430003b0fba901d000");
+	const std::vector<std::byte> message = ebus::Ebus::to_vector("52b509030d0600");
+	const std::vector<std::byte> response = ebus::Ebus::to_vector("03b0fbaa");
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	ebus::Sequence seq;
+	ebus::Telegram tel;
+	bool valid = true;
+
+	// receive bytes from the bus and parse the telegram
+	long start = allocations;
+
+	for (int i = 0; i < repeat; i++)
+	{
+		seq.clear();
+
+		for (const std::byte &byte : raw)
+			seq.push_back(byte, now);
+
+		tel.clear();
+		tel.parse(seq);
+
+		valid &= tel.isValid();
+	}
+
+	report("  parse", allocations - start, valid);
+
+	// parse the reduced bytes in place, master and slave as views
+	ebus::Sequence reduced;
+
+	for (const std::byte &byte : raw)
+		reduced.push_back(byte, now);
+
+	reduced.reduce();
+
+	start = allocations;
+
+	for (int i = 0; i < repeat; i++)
+	{
+		tel.parse(reduced.data(), reduced.size());
+
+		valid &= (tel.isValid() && tel.getMasterView().size() == message.size() + 1
+			&& tel.getSlaveView().size() == response.size());
+	}
+
+	report("   view", allocations - start, valid);
+
+	// build master and slave of a telegram
+	start = allocations;
+
+	for (int i = 0; i < repeat; i++)
+	{
+		tel.clear();
+		tel.createMaster(std::byte(0xff), message);
+		tel.createSlave(response);
+
+		valid &= (tel.getMasterState() == SEQ_OK && tel.getSlaveState() == SEQ_OK);
+	}
+
+	report("  build", allocations - start, valid);
+
+	// prepare the bytes for transmission (reduced, crc, extended)
+	start = allocations;
+
+	for (int i = 0; i < repeat; i++)
+	{
+		ebus::Sequence reduced(tel.getSlave(), 0);
+		reduced.reduce();
+
+		ebus::Sequence data(reduced, 1);
+		data.push_back(tel.getSlaveCRC(), false);
+		data.extend();
+
+		valid &= (data.size() != 0);
+	}
+
+	report(" resend", allocations - start, valid);
+
+	// hand the telegram to several view subscribers
+	std::vector<std::function<void(const ebus::SequenceView &message, const ebus::SequenceView &response)>> subscribers;
+	size_t published = 0;
+
+	for (int i = 0; i < 3; i++)
+		subscribers.push_back([&published](const ebus::SequenceView &message, const ebus::SequenceView &response)
+		{
+			published += message.size() + response.size();
+		});
+
+	start = allocations;
+
+	for (int i = 0; i < repeat; i++)
+		for (const auto &publish : subscribers)
+			publish(tel.getMaster().view(), tel.getSlave().view());
+
+	report("publish", allocations - start, published == size_t(3 * repeat * (message.size() + 1 + response.size())));
+
+	return (EXIT_SUCCESS);
+}
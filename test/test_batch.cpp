@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../src/Sequence.h"
+#include "../src/Telegram.h"
+#include "../src/TelegramBatch.h"
+
+// extended telegrams as seen on the bus, with NAK retries and broken ones
+static const std::vector<std::string> samples =
+{ "ff52b509030d0600430003b0fba901d000",
+  "ff52b509030d060043ffff52b509030d0600430003b0fba901d000",
+  "ff52b509030d060043ffff52b509030d060043ff",
+  "ff52b509030d0600430003b0fba901d0ff0003b0fba901d000",
+  "ff52b509030d060043ffff52b509030d0600430003b0fba901d0ff0003b0fba901d000",
+  "107fc2b5100900024000000000000215",
+  "1008b51101028aff1008b51101028a0003b0fba901d0ff0003b0fba901d0",
+  "ff12b509030d0000d700037702006100",
+  "ff52b509030d060044",
+  "10feb5050427002d0085",
+  "31" };
+
+// one telegram at a time like the bus monitor
+static bool reference(const std::vector<std::byte> &capture, const ebus::TelegramBatch &batch)
+{
+	ebus::Sequence seq;
+
+	for (size_t i = 0; i < batch.count(); i++)
+	{
+		seq.assign(capture.data() + batch.offset[i], batch.length[i]);
+
+		ebus::Telegram tel(seq);
+
+		if (batch.type[i] != tel.get_type() || batch.master_state[i] != tel.getMasterState()
+			|| batch.slave_state[i] != tel.getSlaveState()) return (false);
+
+		if (tel.getMasterState() == SEQ_OK
+			&& (batch.qq[i] != tel.getMaster()[0] || batch.zz[i] != tel.getMaster()[1] || batch.pb[i] != tel.getMaster()[2]
+				|| batch.sb[i] != tel.getMaster()[3] || batch.master_crc[i] != 1)) return (false);
+
+		if (tel.isValid() && tel.get_type() == ebus::Type::MS && batch.slave_crc[i] != 1) return (false);
+	}
+
+	return (true);
+}
+
+int main()
+{
+	const size_t parts = 1000000;
+
+	std::vector<std::vector<std::byte>> telegrams;
+
+	for (const std::string &sample : samples)
+		telegrams.push_back(ebus::Ebus::to_vector(sample));
+
+	std::vector<std::byte> capture;
+	std::srand(1);
+
+	for (size_t i = 0; i < parts; i++)
+	{
+		const std::vector<std::byte> &tel = telegrams[std::rand() % telegrams.size()];
+
+		capture.insert(capture.end(), tel.begin(), tel.end());
+		capture.insert(capture.end(), 1 + std::rand() % 3, ebus::seq_syn);
+	}
+
+	// incomplete telegram at the end
+	capture.insert(capture.end(), telegrams[0].begin(), telegrams[0].begin() + 4);
+
+	const double megabytes = capture.size() / 1e6;
+
+	// one Telegram(Sequence&) at a time
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	ebus::Sequence seq;
+	size_t valid = 0;
+
+	for (const std::byte &byte : capture)
+	{
+		if (byte == ebus::seq_syn)
+		{
+			if (seq.size() == 0) continue;
+
+			ebus::Telegram tel(seq);
+			if (tel.isValid()) valid++;
+
+			seq.clear();
+			continue;
+		}
+
+		seq.push_back(byte);
+	}
+
+	double single = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	std::cout << std::fixed << std::setprecision(1) << "capture: " << megabytes << " MB, " << parts << " telegrams, "
+		<< valid << " valid" << std::endl;
+	std::cout << " single: " << single << " ms (" << parts * 1e-3 / single << " M tel/s)" << std::endl;
+
+	ebus::TelegramBatch batch;
+
+	for (unsigned threads : { 1u, 2u, 4u, std::thread::hardware_concurrency() })
+	{
+		begin = std::chrono::steady_clock::now();
+
+		size_t end = batch.parse(capture.data(), capture.size(), threads);
+
+		double parse = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		size_t count = 0;
+		for (size_t i = 0; i < batch.count(); i++)
+			if (batch.master_state[i] == SEQ_OK && (batch.type[i] != ebus::Type::MS || batch.slave_state[i] == SEQ_OK))
+				count++;
+
+		bool same = batch.count() == parts && count == valid && end == capture.size() - 4;
+
+		std::cout << "  batch: " << std::setw(2) << threads << " threads = " << std::setw(6) << parse << " ms ("
+			<< parts * 1e-3 / parse << " M tel/s) speedup = " << single / parse << "x  same = " << same
+			<< " ref = " << reference(capture, batch) << std::endl;
+	}
+
+	return (EXIT_SUCCESS);
+}
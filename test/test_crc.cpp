@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../src/Crc.h"
+#include "../src/Escape.h"
+#include "../src/Sequence.h"
+
+int main()
+{
+	const size_t count = 1000000;
+
+	std::mt19937 random(42);
+
+	std::vector<std::byte> data;
+	std::vector<size_t> offsets(count);
+	std::vector<size_t> sizes(count);
+	std::vector<std::byte> crcs(count);
+
+	// random telegram parts of 6 to 22 bytes in extended form
+	for (size_t i = 0; i < count; i++)
+	{
+		ebus::Sequence seq;
+		size_t len = 6 + random() % 17;
+
+		for (size_t j = 0; j < len; j++)
+			seq.push_back(std::byte(random() & 0xff), false);
+
+		seq.extend();
+
+		offsets[i] = data.size();
+		sizes[i] = seq.size();
+		data.insert(data.end(), seq.data(), seq.data() + seq.size());
+
+		// every 7th CRC is corrupted
+		crcs[i] = (i % 7 == 0 ? ~seq.crc() : seq.crc());
+	}
+
+	// one part after the other
+	std::vector<std::uint64_t> serial((count + 63) / 64, 0);
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < count; i++)
+		if (ebus::Crc::calc(data.data() + offsets[i], sizes[i]) == crcs[i])
+			serial[i / 64] |= std::uint64_t(1) << (i % 64);
+
+	double serial_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	// batch
+	std::vector<std::uint64_t> batch((count + 63) / 64, 0);
+
+	begin = std::chrono::steady_clock::now();
+
+	ebus::Crc::verify(data.data(), offsets.data(), sizes.data(), crcs.data(), count, batch.data());
+
+	double batch_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+	size_t valid = 0;
+
+	for (size_t i = 0; i < count; i++)
+		if ((batch[i / 64] >> (i % 64)) & 1) valid++;
+
+	std::cout << "  parts: " << count << " bytes = " << data.size() << " valid = " << valid << " (expected "
+		<< count - (count + 6) / 7 << ")" << std::endl;
+	std::cout << " serial: " << serial_time << " ms (" << data.size() / serial_time / 1000 << " MB/s)" << std::endl;
+	std::cout << "  batch: " << batch_time << " ms (" << data.size() / batch_time / 1000 << " MB/s) speedup = "
+		<< serial_time / batch_time << "x same = " << (serial == batch) << std::endl;
+
+	return (EXIT_SUCCESS);
+}
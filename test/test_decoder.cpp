@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../src/Sequence.h"
+#include "../src/Telegram.h"
+#include "../src/TelegramDecoder.h"
+
+// feeds the bytes between two SYN one by one and compares with the telegram parsed at SYN
+static void run(const std::string &name, const std::string &bytes)
+{
+	const std::vector<std::byte> extended = ebus::Ebus::to_vector(bytes);
+
+	ebus::TelegramDecoder decoder;
+	decoder.reset();
+
+	size_t complete = 0;
+
+	for (size_t i = 0; i < extended.size(); i++)
+		if (decoder.feed(extended[i])) complete = i + 1;
+
+	ebus::Telegram streamed;
+	streamed.parse(decoder.data(), decoder.size());
+
+	ebus::Sequence seq;
+	seq.assign(extended);
+
+	ebus::Telegram parsed(seq);
+
+	const bool same = streamed.to_string() == parsed.to_string() && streamed.isValid() == parsed.isValid();
+
+	// a telegram reported with its last byte has to be the one parsed at SYN
+	ebus::Telegram reported;
+	reported.parse(decoder.data(), decoder.length());
+
+	const bool early = complete == 0 || (reported.to_string() == parsed.to_string() && parsed.isValid());
+
+	// a copy owns its parts and stays valid when the parsed buffer is gone
+	std::vector<std::byte> buffer(decoder.data(), decoder.data() + decoder.size());
+
+	ebus::Telegram borrowed;
+	borrowed.parse(buffer.data(), buffer.size());
+
+	const ebus::Telegram copy(borrowed);
+	std::fill(buffer.begin(), buffer.end(), std::byte(0xee));
+
+	const bool copied = copy.to_string() == parsed.to_string();
+
+	std::cout << std::setw(11) << name << ": complete at " << std::setw(2) << complete << " of " << std::setw(2)
+		<< extended.size() << " bytes  valid = " << parsed.isValid() << "  same = " << same << "  early = " << early
+		<< "  copy = " << copied << std::endl;
+}
+
+int main()
+{
+	run("MS", "ff52b509030d0600430003b0fba901d000");
+	run("MM", "1003b51101023900");
+	run("BC", "10feb5050427002d00b4");
+	run("NAK S", "ff52b509030d060043ffff52b509030d0600430003b0fba901d000");
+	run("NAK M", "ff52b509030d0600430003b0fba901d0ff0003b0fba901d000");
+	run("NAK S+M", "ff52b509030d060043ffff52b509030d0600430003b0fba901d0ff0003b0fba901d000");
+	run("2xNAK S", "ff52b509030d060043ffff52b509030d060043ff");
+	run("2xNAK M", "ff52b509030d060043ffff52b509030d0600430003b0fba901d0ff0003b0fba901d0ff");
+	run("CRC", "ff52b509030d060044ff");
+	run("short", "ff52b509");
+	run("lock", "31");
+	run("trail MS", "ff52b509030d0600430003b0fba901d0001008");
+	run("trail BC", "10feb5050427002d00b410");
+	run("trail NAK S", "ff52b509030d060043ffff52b509030d0600430003b0fba901d00010");
+	run("trail NAK M", "ff52b509030d0600430003b0fba901d0ff0003b0fba901d00010");
+
+	return (EXIT_SUCCESS);
+}
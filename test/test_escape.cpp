@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../src/Escape.h"
+#include "../src/EscapeScan.h"
+#include "../src/Sequence.h"
+
+// former implementation: temporary vector, byte by byte through at()
+static void legacy_extend(std::vector<std::byte> &seq)
+{
+	std::vector<std::byte> tmp;
+
+	for (size_t i = 0; i < seq.size(); i++)
+	{
+		if (seq.at(i) == ebus::seq_syn)
+		{
+			tmp.push_back(ebus::seq_exp);
+			tmp.push_back(ebus::seq_synexp);
+		}
+		else if (seq.at(i) == ebus::seq_exp)
+		{
+			tmp.push_back(ebus::seq_exp);
+			tmp.push_back(ebus::seq_expexp);
+		}
+		else
+		{
+			tmp.push_back(seq.at(i));
+		}
+	}
+
+	seq = tmp;
+}
+
+static void legacy_reduce(std::vector<std::byte> &seq)
+{
+	std::vector<std::byte> tmp;
+	bool extended = false;
+
+	for (size_t i = 0; i < seq.size(); i++)
+	{
+		if (seq.at(i) == ebus::seq_syn || seq.at(i) == ebus::seq_exp)
+		{
+			extended = true;
+		}
+		else if (extended)
+		{
+			if (seq.at(i) == ebus::seq_synexp)
+				tmp.push_back(ebus::seq_syn);
+			else
+				tmp.push_back(ebus::seq_exp);
+
+			extended = false;
+		}
+		else
+		{
+			tmp.push_back(seq.at(i));
+		}
+	}
+
+	seq = tmp;
+}
+
+static void run(const std::string &name, const std::string &str)
+{
+	const int repeat = 200000;
+
+	const std::vector<std::byte> reduced = ebus::Ebus::to_vector(str);
+
+	// legacy round trip
+	std::vector<std::byte> vec = reduced;
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repeat; i++)
+	{
+		legacy_extend(vec);
+		legacy_reduce(vec);
+	}
+
+	double legacy = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / repeat;
+
+	// in place round trip
+	ebus::Sequence seq;
+	seq.assign(reduced, false);
+
+	begin = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repeat; i++)
+	{
+		seq.extend();
+		seq.reduce();
+	}
+
+	double codec = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / repeat;
+
+	// streaming into a caller buffer
+	std::byte extended[2 * ebus::Sequence::capacity];
+	std::byte result[ebus::Sequence::capacity];
+	size_t size = 0;
+
+	begin = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < repeat; i++)
+	{
+		size_t len = ebus::EscapeEncoder::encode(reduced.data(), reduced.size(), extended);
+		size = ebus::EscapeDecoder::decode(extended, len, result);
+	}
+
+	double stream = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / repeat;
+
+	bool same = (vec == reduced && seq.get_sequence() == reduced
+		&& std::vector<std::byte>(result, result + size) == reduced);
+
+	std::cout << std::setw(7) << name << ": " << std::setw(2) << reduced.size() << " bytes  legacy = " << std::setw(7)
+		<< std::fixed << std::setprecision(1) << legacy << " ns  in place = " << std::setw(6) << codec << " ns  stream = "
+		<< std::setw(6) << stream << " ns  speedup = " << std::setprecision(1) << legacy / codec << "x  same = " << same
+		<< std::endl;
+}
+
+// capture of SYN separated telegrams, split and unescaped at once
+static void bulk()
+{
+	const size_t parts = 1000000;
+
+	std::vector<std::byte> capture;
+	std::srand(1);
+
+	for (size_t i = 0; i < parts; i++)
+	{
+		std::byte reduced[32];
+		size_t len = 8 + std::rand() % 24;
+
+		for (size_t j = 0; j < len; j++)
+			reduced[j] = std::byte(std::rand() % 100 == 0 ? 0xa9 + std::rand() % 2 : std::rand() % 0xa9);
+
+		std::byte extended[64];
+		size_t size = ebus::EscapeEncoder::encode(reduced, len, extended);
+
+		capture.insert(capture.end(), extended, extended + size);
+		capture.insert(capture.end(), 1 + std::rand() % 3, ebus::seq_syn);
+	}
+
+	std::vector<size_t> offsets(parts), sizes(parts);
+	std::vector<std::byte> expected(capture.size()), output(capture.size());
+
+	// byte at a time state machine as reference
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	size_t reference = 0;
+	ebus::EscapeDecoder decoder;
+
+	for (const std::byte &byte : capture)
+	{
+		if (byte == ebus::seq_syn)
+		{
+			decoder.reset();
+			continue;
+		}
+
+		if (decoder.feed(byte, expected[reference])) reference++;
+	}
+
+	double scalar = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	const double megabytes = capture.size() / 1e6;
+
+	std::cout << std::setprecision(1) << "   bulk: " << megabytes << " MB  state machine = " << scalar << " ms ("
+		<< megabytes * 1e3 / scalar << " MB/s)" << std::endl;
+
+	for (ebus::EscapeScan::Isa isa : { ebus::EscapeScan::Isa::scalar, ebus::EscapeScan::Isa::sse2, ebus::EscapeScan::Isa::avx2 })
+	{
+		if (!ebus::EscapeScan::select(isa)) continue;
+
+		size_t next = 0;
+
+		begin = std::chrono::steady_clock::now();
+
+		size_t count = ebus::EscapeScan::split(capture.data(), capture.size(), offsets.data(), sizes.data(), parts, next);
+
+		double split = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		bool same = count == parts;
+
+		begin = std::chrono::steady_clock::now();
+
+		count = ebus::EscapeScan::decode(capture.data(), capture.size(), output.data(), offsets.data(), sizes.data(), parts,
+			next);
+
+		double decode = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+		same &= count == parts && offsets[count - 1] + sizes[count - 1] == reference
+			&& std::equal(expected.begin(), expected.begin() + reference, output.begin());
+
+		std::cout << std::setw(7) << ebus::EscapeScan::name(isa) << ": split = " << split << " ms (" << megabytes * 1e3 / split
+			<< " MB/s)  split + decode = " << decode << " ms (" << megabytes * 1e3 / decode << " MB/s) speedup = "
+			<< scalar / decode << "x  same = " << same << std::endl;
+	}
+}
+
+int main()
+{
+	// round trip extend + reduce per telegram part
+	run("short", "ff52b509030d0600");
+	run("slave", "03b0fbaa");
+	run("long", "ff15b5091300aaa90102030405060708090a0b0c0d0e0f10");
+	run("full", "ff52b509030d060043000aaaa9a9aaa9aaa9aaa9aa010203d0");
+
+	bulk();
+
+	return (EXIT_SUCCESS);
+}
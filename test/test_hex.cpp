@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../include/ebus/Hex.h"
+
+// previous stream based implementations as reference
+static std::string stream_encode(const std::vector<std::byte> &vec)
+{
+	std::ostringstream ostr;
+
+	for (size_t i = 0; i < vec.size(); i++)
+		ostr << std::nouppercase << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned>(vec[i]);
+
+	return (ostr.str());
+}
+
+static std::vector<std::byte> stream_decode(const std::string &str)
+{
+	std::vector<std::byte> result;
+
+	for (size_t i = 0; i + 1 < str.size(); i += 2)
+		result.push_back(std::byte(std::strtoul(str.substr(i, 2).c_str(), nullptr, 16)));
+
+	return (result);
+}
+
+template<typename Function>
+static double measure(const size_t loops, Function function)
+{
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < loops; i++)
+		function();
+
+	return (std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / loops);
+}
+
+static void run(const std::string &name, const std::string &digits)
+{
+	const size_t loops = 200000;
+
+	const std::vector<std::byte> bytes = stream_decode(digits);
+	std::vector<std::byte> decoded(bytes.size());
+	std::string encoded(2 * bytes.size(), '0');
+
+	size_t sink = 0;
+
+	const double old_encode = measure(loops, [&]()
+	{ sink += stream_encode(bytes).size(); });
+
+	const double new_string = measure(loops, [&]()
+	{ sink += ebus::Ebus::to_string(bytes).size(); });
+
+	const double new_encode = measure(loops, [&]()
+	{ sink += ebus::hex::encode(bytes.data(), bytes.size(), encoded.data()); });
+
+	const double old_decode = measure(loops, [&]()
+	{ sink += stream_decode(digits).size(); });
+
+	const double new_vector = measure(loops, [&]()
+	{ sink += ebus::Ebus::to_vector(digits).size(); });
+
+	const double new_decode = measure(loops, [&]()
+	{ sink += ebus::hex::decode(digits.data(), digits.size(), decoded.data()); });
+
+	const bool same = sink != 0 && encoded == digits && decoded == bytes && ebus::Ebus::to_string(bytes) == digits
+		&& ebus::Ebus::to_vector(digits) == bytes;
+
+	std::cout << std::fixed << std::setprecision(1) << std::setw(6) << name << ": " << std::setw(2) << bytes.size()
+		<< " bytes  encode: stream = " << std::setw(6) << old_encode << " ns  to_string = " << std::setw(5) << new_string
+		<< " ns  buffer = " << std::setw(5) << new_encode << " ns  speedup = " << std::setw(5) << old_encode / new_encode
+		<< "x" << std::endl;
+	std::cout << "        decode: strtoul = " << std::setw(6) << old_decode << " ns  to_vector = " << std::setw(5) << new_vector
+		<< " ns  buffer = " << std::setw(5) << new_decode << " ns  speedup = " << std::setw(5) << old_decode / new_decode
+		<< "x  same = " << same << std::endl;
+}
+
+int main()
+{
+	// all bytes, upper case digits are accepted
+	std::vector<std::byte> all;
+	for (int i = 0; i < 256; i++)
+		all.push_back(std::byte(i));
+
+	const std::string lower = stream_encode(all);
+	std::string upper = lower;
+	for (char &c : upper)
+		c = char(std::toupper(c));
+
+	std::vector<std::byte> decoded(all.size());
+
+	std::cout << "  round: encode = " << (ebus::Ebus::to_string(all) == lower) << " decode = "
+		<< (ebus::hex::decode(upper.data(), upper.size(), decoded.data()) == all.size() && decoded == all) << std::endl;
+
+	// invalid input is reported, to_vector stays lenient like before
+	std::cout << "invalid: odd = " << (ebus::hex::decode("0a1", 3, decoded.data()) == ebus::hex::invalid) << " digit = "
+		<< (ebus::hex::decode("0g", 2, decoded.data()) == ebus::hex::invalid) << " to_vector = "
+		<< (ebus::Ebus::to_vector("1g0a2") == stream_decode("1g0a2")) << std::endl << std::endl;
+
+	run("slave", "03b0fbaa");
+	run("master", "ff52b509030d060043");
+	run("full", "ff52b509030d0600430003b0fba901d000");
+	run("long", "ff15b5091300aaa90102030405060708090a0b0c0d0e0f10");
+
+	return (EXIT_SUCCESS);
+}
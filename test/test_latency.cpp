@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "../src/Device.h"
+#include "../src/VirtualBus.h"
+
+// round trip time of single bytes through the echo of a virtual bus
+static void run(ebus::VirtualBus &bus, const bool lowLatency)
+{
+	const int count = 1000;
+
+	ebus::Device dev(bus.name());
+	dev.setLowLatency(lowLatency);
+	dev.open();
+
+	ebus::LowLatency state = dev.lowLatency();
+
+	std::cout << "    low latency: " << state.enabled << " ASYNC_LOW_LATENCY = " << state.async_low_latency
+		<< " latency_timer = " << state.latency_timer << std::endl;
+
+	std::vector<double> rtt;
+
+	for (int i = 0; i < count; i++)
+	{
+		std::byte byte = std::byte(i % 0x80);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		dev.send(byte);
+		dev.recv(byte, 1, 0);
+
+		rtt.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	std::sort(rtt.begin(), rtt.end());
+
+	std::cout << "            rtt: min = " << rtt.front() << " us, median = " << rtt[rtt.size() / 2] << " us, p99 = "
+		<< rtt[rtt.size() * 99 / 100] << " us, max = " << rtt.back() << " us" << std::endl << std::endl;
+
+	dev.close();
+}
+
+int main()
+{
+	// no SYN generation during measurement
+	ebus::VirtualBus bus(60000000L);
+	bus.start();
+
+	run(bus, false);
+	run(bus, true);
+
+	bus.stop();
+
+	return (0);
+}
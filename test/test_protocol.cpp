@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/ebus/Protocol.h"
+#include "../src/Sequence.h"
+#include "../src/Telegram.h"
+
+static_assert(ebus::protocol::is_master(std::byte(0xff)), "0xff is a master");
+static_assert(!ebus::protocol::is_master(std::byte(0x08)), "0x08 is no master");
+static_assert(ebus::protocol::is_slave(std::byte(0x08)), "0x08 is a slave");
+static_assert(!ebus::protocol::is_valid(std::byte(0xaa)), "0xaa is no address");
+static_assert(ebus::protocol::slave_address(std::byte(0x10)) == std::byte(0x15), "slave of 0x10 is 0x15");
+static_assert(ebus::protocol::slave_address(std::byte(0xff)) == std::byte(0x04), "slave of 0xff is 0x04");
+static_assert(ebus::protocol::crc_table[1] == std::byte(0x9b), "crc table starts with the polynom");
+
+// fixed requests, prepared by the compiler
+constexpr auto poll_status = ebus::protocol::telegram(std::byte(0xff), "52b509030d0600");
+constexpr auto poll_escaped = ebus::protocol::telegram(std::byte(0x10), "08b5090401a9aa00");
+constexpr auto poll_broadcast = ebus::protocol::telegram(std::byte(0x03), "fe0700030a1405");
+
+static_assert(poll_status[0] == std::byte(0xff), "source address comes first");
+static_assert(poll_escaped.size > 11, "escapes expected");
+
+static std::vector<std::byte> to_vector(const std::string &str)
+{
+	std::vector<std::byte> result;
+
+	for (size_t i = 0; i + 1 < str.size(); i += 2)
+		result.push_back(std::byte(std::strtoul(str.substr(i, 2).c_str(), nullptr, 16)));
+
+	return (result);
+}
+
+template<size_t N>
+static void check(const std::byte source, const std::string &message, const ebus::protocol::Wire<N> &wire)
+{
+	std::ostringstream ostr;
+
+	for (size_t i = 0; i < wire.size; i++)
+		ostr << std::nouppercase << std::hex << std::setw(2) << std::setfill('0')
+			<< std::to_integer<int>(wire[i]);
+
+	ebus::Telegram tel;
+	tel.createMaster(source, to_vector(message));
+
+	ebus::Sequence seq = tel.getMaster();
+	seq.push_back(tel.getMasterCRC(), false);
+	seq.extend();
+
+	bool same = seq.size() == wire.size && tel.getMasterCRC() == wire.crc;
+
+	for (size_t i = 0; same && i < wire.size; i++)
+		same = seq[i] == wire[i];
+
+	std::cout << "wire: " << ostr.str() << (same ? " same" : " differs") << std::endl;
+}
+
+int main()
+{
+	check(std::byte(0xff), "52b509030d0600", poll_status);
+	check(std::byte(0x10), "08b5090401a9aa00", poll_escaped);
+	check(std::byte(0x03), "fe0700030a1405", poll_broadcast);
+
+	return (0);
+}
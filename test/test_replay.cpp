@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../src/Sequence.h"
+
+// extended bytes of a reduced sequence followed by its crc
+static std::vector<std::byte> wire(const std::string &str)
+{
+	ebus::Sequence seq;
+	seq.assign(ebus::Ebus::to_vector(str), false);
+
+	std::byte crc = seq.crc();
+
+	seq.reduce();
+	seq.push_back(crc, false);
+	seq.extend();
+
+	return (seq.get_sequence());
+}
+
+static void append(std::vector<std::byte> &capture, const std::vector<std::byte> &data)
+{
+	capture.insert(capture.end(), data.begin(), data.end());
+}
+
+static void run(const std::string &prefix, const std::string &file)
+{
+	ebus::Ebus ebus(std::byte(0xff), prefix + file);
+
+	std::atomic<int> count = 0;
+
+	ebus.register_publish([&count](const std::vector<std::byte>&, const std::vector<std::byte>&)
+	{
+		count++;
+	});
+
+	// a replay starts with open() only, no telegram is missed
+	ebus.open();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < 50 && !ebus.online(); i++)
+		usleep(10000);
+
+	for (int i = 0; i < 500 && ebus.online(); i++)
+		usleep(10000);
+
+	double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << " device: " << prefix << "... telegrams = " << count << " online = " << ebus.online()
+		<< (duration < 1000 ? " (< 1 s)" : " (>= 1 s)") << std::endl;
+}
+
+int main()
+{
+	const int repeat = 10;
+
+	std::vector<std::byte> capture = ebus::Ebus::to_vector("aaaa");
+
+	for (int i = 0; i < repeat; i++)
+	{
+		// master slave
+		append(capture, wire("1052b509030d0600"));
+		append(capture, ebus::Ebus::to_vector("00"));
+		append(capture, wire("03b0fbaa"));
+		append(capture, ebus::Ebus::to_vector("00aa"));
+
+		// broadcast
+		append(capture, wire("10feb5050427002d00"));
+		append(capture, ebus::Ebus::to_vector("aaaa"));
+	}
+
+	char name[] = "/tmp/test_replay_XXXXXX";
+	int fd = mkstemp(name);
+	if (fd < 0) return (EXIT_FAILURE);
+
+	close(fd);
+
+	std::ofstream(name, std::ios::binary).write(reinterpret_cast<const char*>(capture.data()), capture.size());
+
+	std::cout << "capture: " << capture.size() << " bytes, " << 2 * repeat << " telegrams" << std::endl << std::endl;
+
+	run("replay:", name);
+	run("replay-paced:", name);
+
+	std::remove(name);
+
+	return (EXIT_SUCCESS);
+}
@@ -20,6 +20,7 @@
 #include <cstddef>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "../include/ebus/Ebus.h"
 #include "../src/Sequence.h"
@@ -134,5 +135,14 @@ int main()
 	std::cout << "    seq: " << seq.to_string() << std::endl;
 	std::cout << "  full6: " << full6.to_string() << std::endl << std::endl;
 
+	// running crc stays the same in extended and reduced form
+	seq.assign(ebus::Ebus::to_vector("03b0fba901"));
+	std::byte crc = seq.crc();
+	seq.reduce();
+
+	std::cout << "    seq: 03b0fba901" << std::endl;
+	std::cout << "    crc: extended = " << ebus::Ebus::to_string(std::vector<std::byte>(1, crc)) << " reduced = "
+		<< ebus::Ebus::to_string(std::vector<std::byte>(1, seq.crc())) << std::endl << std::endl;
+
 	return (0);
 }
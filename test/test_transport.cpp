@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../src/Device.h"
+
+// loopback echo server, returns every received byte and closes after 'count' bytes
+static void echo(const int server, const size_t count)
+{
+	int client = accept(server, nullptr, nullptr);
+
+	char buffer[64];
+	size_t total = 0;
+
+	while (total < count)
+	{
+		ssize_t nbytes = read(client, buffer, sizeof(buffer));
+		if (nbytes <= 0) break;
+
+		write(client, buffer, nbytes);
+		total += nbytes;
+	}
+
+	close(client);
+}
+
+int main()
+{
+	int server = socket(AF_INET, SOCK_STREAM, 0);
+
+	struct sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+
+	socklen_t len = sizeof(addr);
+
+	bind(server, reinterpret_cast<struct sockaddr*>(&addr), len);
+	listen(server, 1);
+	getsockname(server, reinterpret_cast<struct sockaddr*>(&addr), &len);
+
+	const std::vector<std::byte> seq = ebus::Ebus::to_vector("aaff52b509030d060043");
+
+	std::thread thread(echo, server, seq.size());
+
+	std::string device = "tcp:127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+	ebus::Device dev(device);
+
+	dev.open();
+	std::cout << " device: " << device << " open = " << dev.isOpen() << std::endl << std::endl;
+
+	// echo
+	std::vector<std::byte> echo;
+
+	for (const std::byte &byte : seq)
+		dev.send(byte);
+
+	for (size_t i = 0; i < seq.size(); i++)
+	{
+		std::byte byte;
+		dev.recv(byte, 1, 0);
+		echo.push_back(byte);
+	}
+
+	std::cout << "   sent: " << ebus::Ebus::to_string(seq) << std::endl;
+	std::cout << "   echo: " << ebus::Ebus::to_string(echo) << std::endl << std::endl;
+
+	thread.join();
+
+	// peer closed
+	try
+	{
+		std::byte byte;
+		dev.recv(byte, 1, 0);
+	} catch (const std::exception &ex)
+	{
+		std::cout << "  close: " << ex.what() << std::endl;
+	}
+
+	std::cout << "   open: " << dev.isOpen() << " disconnects = " << dev.counters().disconnects << std::endl << std::endl;
+
+	// peer closes before a write: the write fails like any device error instead of raising SIGPIPE
+	std::thread closer([server]()
+	{
+		close(accept(server, nullptr, nullptr));
+	});
+
+	ebus::Device dev2(device);
+	dev2.open();
+
+	closer.join();
+
+	try
+	{
+		for (int i = 0; i < 10; i++)
+		{
+			dev2.send(seq.front());
+			usleep(10000);
+		}
+	} catch (const std::exception &ex)
+	{
+		std::cout << "  write: " << ex.what() << std::endl;
+	}
+
+	std::cout << "   open: " << dev2.isOpen() << " disconnects = " << dev2.counters().disconnects << std::endl;
+
+	close(server);
+
+	return (0);
+}
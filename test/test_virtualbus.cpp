@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) Roland Jax 2012-2019 <roland.jax@liwest.at>
+ *
+ * This file is part of ebus.
+ *
+ * ebus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ebus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ebus. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../include/ebus/Ebus.h"
+#include "../src/VirtualBus.h"
+
+// logger of a sniffer: info level, counts what reaches it (slow like a flushed file if wanted)
+class CountingLogger : public ebus::ILogger
+{
+
+public:
+	std::atomic<long> info_count = 0;
+	std::atomic<long> detail_count = 0;
+	bool slow = false;
+
+	ebus::LogLevel level() const override
+	{
+		return (ebus::LogLevel::info);
+	}
+
+	void error(const std::string&) override
+	{
+	}
+
+	void warn(const std::string&) override
+	{
+	}
+
+	void info(const std::string&) override
+	{
+		if (slow) usleep(2000);
+
+		info_count++;
+	}
+
+	void debug(const std::string&) override
+	{
+		detail_count++;
+	}
+
+	void trace(const std::string&) override
+	{
+		detail_count++;
+	}
+
+};
+
+static void run(const bool enhanced, const bool pipelined, const bool realtime = false, const bool async_log = false,
+	const bool foreign = false)
+{
+	const int count = 100;
+
+	ebus::VirtualBus bus(10000L, enhanced);
+	bus.add_response(ebus::Ebus::to_vector("52b509030d0600"), ebus::Ebus::to_vector("03b0fbaa"));
+	bus.add_response(ebus::Ebus::to_vector("10b5050427002d00"), std::vector<std::byte>());
+
+	// broadcasts of a master with higher priority
+	if (foreign) bus.add_master(ebus::Ebus::to_vector("10feb5050427002d00b4"), 3);
+	bus.start();
+
+	const std::string device = (enhanced ? "enh:" : "") + bus.name();
+
+	ebus::Ebus ebus(std::byte(0xff), device);
+	ebus.set_lock_counter_max(1);
+	ebus.set_pipelined_send(pipelined);
+
+	std::shared_ptr<CountingLogger> logger = std::make_shared<CountingLogger>();
+	ebus.register_logger(logger);
+
+	if (async_log)
+	{
+		logger->slow = true;
+		ebus.set_async_log(true);
+	}
+
+	if (realtime)
+	{
+		ebus::RealTime rt;
+		rt.priority = 10;
+		rt.cpu = 0;
+		rt.lock_memory = true;
+
+		ebus.set_realtime(rt);
+	}
+
+	// bus time of the last published telegram
+	double duration = 0;
+	std::atomic<size_t> published = 0;
+
+	ebus.register_publish(
+		[&duration, &published](const std::vector<std::byte>&, const std::vector<std::byte>&,
+			const std::chrono::steady_clock::time_point &begin, const std::chrono::steady_clock::time_point &end)
+		{
+			duration = std::chrono::duration<double, std::milli>(end - begin).count();
+			published++;
+		});
+
+	for (int i = 0; i < 50 && !ebus.online(); i++)
+		usleep(100000);
+
+	ebus::RealTime rt = ebus.realtime();
+
+	std::cout << " device: " << device << " online = " << ebus.online() << " pipelined = " << pipelined << std::endl;
+	std::cout << "     rt: priority = " << rt.priority << " cpu = " << rt.cpu << " lock_memory = " << rt.lock_memory
+		<< std::endl << std::endl;
+
+	// master slave
+	std::vector<std::byte> response;
+	int result = ebus.transmit(ebus::Ebus::to_vector("52b509030d0600"), response);
+
+	std::cout << "     MS: 52b509030d0600 " << ebus::Ebus::to_string(response) << " -> result = " << result
+		<< " (" << duration << " ms on bus)" << std::endl;
+
+	// master master
+	result = ebus.transmit(ebus::Ebus::to_vector("10b5050427002d00"), response);
+
+	std::cout << "     MM: 10b5050427002d00 -> result = " << result << std::endl;
+
+	// broadcast
+	result = ebus.transmit(ebus::Ebus::to_vector("feb5050427002d00"), response);
+
+	std::cout << "     BC: feb5050427002d00 -> result = " << result << std::endl << std::endl;
+
+	// throughput and latency
+	std::vector<double> latency;
+	int errors = 0;
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < count; i++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		if (ebus.transmit(ebus::Ebus::to_vector("52b509030d0600"), response) != 0) errors++;
+
+		latency.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	std::sort(latency.begin(), latency.end());
+
+	std::cout << "  count: " << count << " errors = " << errors << std::endl;
+	std::cout << " tel/s : " << count / seconds << std::endl;
+	std::cout << "latency: min = " << latency.front() << " ms, median = " << latency[latency.size() / 2] << " ms, max = "
+		<< latency.back() << " ms" << std::endl;
+	ebus::ArbitrationStats arb = ebus.arbitration_stats();
+
+	std::cout << "    arb: attempts = " << arb.attempts << " won = " << arb.won << " lost = " << arb.lost << " missed = "
+		<< arb.missed << " timeouts = " << arb.timeouts << std::endl;
+	std::cout << "    arb: send error mean = " << arb.send_error_mean << " us, max = " << arb.send_error_max
+		<< " us, echo delay min = " << arb.echo_delay_min << " us, mean = " << arb.echo_delay_mean << " us, max = "
+		<< arb.echo_delay_max << " us" << std::endl;
+	ebus::TimingStats timing = ebus.timing_stats();
+
+	std::cout << " timing: replies = " << timing.replies << " missed = " << timing.missed << " delay max = "
+		<< timing.delay_max << " us" << std::endl;
+	std::cout << "    log: info = " << (logger->info_count > 0) << " debug/trace = " << logger->detail_count
+		<< " lost = " << ebus.log_overflows() << std::endl;
+	std::cout << "   bus : " << bus.syn_count() << " SYN, " << bus.telegram_count() << " telegrams, " << published
+		<< " published" << std::endl << std::endl;
+
+	ebus.close();
+	bus.stop();
+}
+
+int main()
+{
+	// arbitration by timing in user space
+	run(false, false);
+
+	// pipelined sending with bulk echo verification
+	run(false, true);
+
+	// arbitration by the adapter (enhanced protocol)
+	run(true, true);
+
+	// real-time profile of the bus thread
+	run(false, true, true);
+
+	// asynchronous logging to a slow logger
+	run(false, true, false, true);
+
+	// arbitration by the adapter against another master (lost or delayed by its telegrams)
+	run(true, true, false, false, true);
+
+	return (0);
+}